@@ -1,127 +1,163 @@
 /**
  * @file 3d.c
- * @brief Rotate a third-order tensor represented by a one-dimensional buffer.
+ * @brief View and rotate a third-order tensor in the terminal.
  * @author Justin Thoreson
  *
- * A third-order tensor can be thought of as the three-dimensional equivalent
- * of an array or matrix. Here, I represent a third-order tensor with a simple
- * one-dimensional buffer. In this case, the third-order tensor has uniform
- * dimensions (the width, height, and depth are all equal to one another).
- *
- * In the one-dimensional buffer, each index must map to an element. Therefore,
- * I treat the dimensions of the third-order tensor with the width as the most
- * significant dimension, the height as the next significant dimension, and the
- * depth as the least significant dimension. Thus, it follows that whenever the
- * index increments by one, then the width increases by one; whenever the index
- * increments to a number divisible by the width, then the height increases by
- * one; whenever the index increments to a number divisible by the width
- * multiplied by the height, the depth increases by one. The width corresponds
- * to the x-axis, the height corresponds to the y-axis, and the depth
- * corresponds to the z-axis. The positive direction of all axes are in the
- * direction the dimension and index increases.
- *
- *            18 19 20
- *            21 22 23
- *            24 25 26
- *                    /
- *         9 10 11   /
- *        12 13 14  / h
- *        15 16 17 / t
- *                / p
- * h   width     / e
- * e   -----    / d
- * i | 0 1 2   /
- * g | 3 4 5  /
- * h | 6 7 8 /
- * t
- *
+ * The tensor engine lives in tensor3.c; this file holds the command line,
+ * the terminal, and the keyboard.
  */
 
+#define _GNU_SOURCE
+
+#include <poll.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "tensor3.h"
+
+/**
+ * @brief The duration of a rotation animation in seconds.
+ */
+#define ANIMATION_SECONDS 0.25
+
+/**
+ * @brief The magic bytes starting an input log.
+ */
+#define INPUT_MAGIC "3DINPUT1"
+
+/**
+ * @brief The number of records sent to a standby between hash checks.
+ */
+#define REPLICA_HASH_INTERVAL 64
+
+/**
+ * @brief The width of a montage tile's label, such as "z49*".
+ */
+#define MONTAGE_LABEL_WIDTH 4
+
 /**
- * @brief The program's minimum allowed dimension for a third-order tensor.
+ * @brief The longest cursor movement a montage frame holds, "\x1b[row;colH".
  */
-const uint8_t TENSOR3_DIM_MIN = 3;
+#define MONTAGE_MOVE_MAX 16
 
 /**
- * @brief The program's maximum allowed dimension for a third-order tensor.
+ * @brief The terminal width assumed when it cannot be queried.
  */
-const uint8_t TENSOR3_DIM_MAX = 50;
+#define TERMINAL_COLUMNS_DEFAULT 80
 
 /**
- * @brief A third-order tensor represented by a one-dimensional buffer.
+ * @brief Options parsed from the command line.
  */
 typedef struct {
-	uint8_t* buffer;
 	uint8_t dimension;
-	uint8_t section;
-	uint16_t section_size;
-	uint32_t size;
-} tensor3_t;
+	const char* import_path;
+	const char* snapshot_path;
+	uint8_t hot_sections;
+	uint8_t channels;
+	uint8_t workers;
+	kernel_t kernel;
+	uint8_t intensity_channels;
+	double step_degrees;
+	uint8_t animation_fps;
+	uint32_t benchmark_rotations;
+	region_t box;
+	const char* tune_path;
+	const char* metrics_path;
+	bool memory_report;
+	uint32_t verify_trials;
+	uint32_t verify_seed;
+	uint64_t soak_operations;
+	uint32_t soak_seed;
+	const char* batch_manifest;
+	uint8_t batch_threads;
+	symmetry_t batch_program;
+	const char* record_path;
+	const char* replay_path;
+	bool replay_fast;
+	const char* replica_path;
+	const char* standby_path;
+	uint8_t montage_stride;
+} options_t;
 
 /**
- * @brief A coordinate representing an element within a third-order tensor.
+ * @brief The hot standby the operation log of the session is sent to.
+ *
+ * The standby is dropped (fd is -1) once a record fails to reach it; the
+ * session carries on without it. records counts the records sent since the
+ * last hash check.
  */
 typedef struct {
-	uint8_t x, y, z;
-} coordinate_t;
+	int fd;
+	uint32_t records;
+} replica_t;
 
 /**
- * @brief Four coordinates within a third-order tensor whose elements must be
- *        rotated 90 degress.
+ * @brief What a montage tile showed when it was last drawn.
  *
- * Rotating the elements of a matrix (or, rather, a cross section of a
- * third-order tensor) 90 degrees cannot be done completely in-place, as
- * elements will be overwritten. To do in-place rotation, and even just to
- * calculate the corresponding index in which an element will be rotated to,
- * we can group elements of the cross section into quartets: groups of four
- * that can be rotated in tandem. Instead of creating a copy of the entire
- * cross section, only the quartet of elements need to be copied to prevent
- * overwritting the data which is also rotated. Element one takes the position
- * of element two, element two takes the position of element three, element
- * three takes the position of element four, and element four takes the
- * position of element one. This structure tracks the coordinates of the four
- * cooresponding elements.
+ * A tile only depends on the checksum of its section as stored in the
+ * buffer, on where the x-axis and y-axis origins put the section's rows and
+ * columns, and on whether it is the current section.
  */
 typedef struct {
-	coordinate_t first, second, third, fourth;
-} quartet_t;
+	uint32_t checksum;
+	uint8_t origin[2];
+	bool current;
+} montage_tile_t;
 
 /**
- * @brief Enumeration of all axes of a third-order tensor.
+ * @brief The montage view: every stride-th section of the current channel,
+ *        laid out in a grid of labelled tiles.
  *
- * The positive x-axis points to the right.
- * The negative x-axis points to the left.
- * The positive y-axis points downward.
- * The negative y-axis points upward.
- * The positive z-axis points inward (toward the screen).
- * The negative z-axis points outward (toward the viewer).
+ * Frames are assembled in a buffer allocated once for the largest tensor
+ * and written with a single write. Once a frame is on screen, the next one
+ * only redraws the tiles whose section changed; valid is cleared when the
+ * screen no longer shows the montage or its layout changed.
+ */
+typedef struct {
+	bool enabled;
+	bool valid;
+	uint8_t stride;
+	uint8_t dimension;
+	uint8_t channel;
+	uint8_t columns;
+	char* frame;
+	size_t capacity;
+	montage_tile_t tiles[UINT8_MAX];
+} montage_t;
+
+/**
+ * @brief The source of keyboard input: the terminal, whose bytes may be
+ *        recorded to a log, or a log being replayed.
  *
- *           -y    +z (far)
- *             |  /
- *             | /
- *             |/
- *     -x -----+----- +x
- *            /
- *           / |
- *          /  |
- * (near) -z    +y
- */
-typedef enum {
-	AXIS_XPOSITIVE,	
-	AXIS_XNEGATIVE,
-	AXIS_YPOSITIVE,	
-	AXIS_YNEGATIVE,
-	AXIS_ZPOSITIVE,	
-	AXIS_ZNEGATIVE,
-} axis_t;
+ * A log holds INPUT_MAGIC followed by one record per byte: the microseconds
+ * elapsed since the previous byte (or the start of the session) as a native
+ * uint32_t, then the byte. A replay delivers every byte at its recorded time,
+ * or as soon as it is asked for if fast is set, and accumulates how long the
+ * program spent handling each byte and how late the bytes were delivered.
+ */
+typedef struct {
+	FILE* record;
+	FILE* replay;
+	bool fast;
+	struct timespec start;
+	uint64_t last;
+	bool available;
+	uint8_t next;
+	uint64_t due;
+	uint64_t delivered;
+	uint32_t count;
+	uint64_t handling_total;
+	uint64_t handling_max;
+	uint64_t late_total;
+	uint64_t late_max;
+} input_t;
 
 /**
  * @brief Retrieve the current terminal settings.
@@ -164,6 +200,18 @@ static struct termios terminal_init() {
 	return orig_terminal;
 }
 
+/**
+ * @brief Query the width of the terminal.
+ * @return The number of columns of the terminal, or TERMINAL_COLUMNS_DEFAULT
+ *         if the output is not a terminal.
+ */
+static uint16_t terminal_columns() {
+	struct winsize size;
+	if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) || !size.ws_col)
+		return TERMINAL_COLUMNS_DEFAULT;
+	return size.ws_col;
+}
+
 /**
  * @brief Clear the terminal and reset the cursor.
  */
@@ -190,408 +238,957 @@ static bool uint8_parse(const char* const arg, uint8_t* const value) {
 }
 
 /**
- * @brief Initialize a third-order tensor from string arguments.
+ * @brief Parse a comma-separated list of channel indices into a bit mask.
+ * @param[in] arg The list of channels, such as "1,2".
+ * @param[out] mask The bit mask with the bit of every listed channel set.
+ * @return true if every channel index was valid, false otherwise
+ */
+static bool channels_parse(const char* arg, uint8_t* const mask) {
+	*mask = 0;
+	while (*arg) {
+		unsigned channel;
+		int length;
+		if (sscanf(arg, "%u%n", &channel, &length) != 1 || channel >= TENSOR3_CHANNELS_MAX)
+			return false;
+		*mask |= (uint8_t)(1u << channel);
+		arg += length;
+		if (*arg == ',')
+			arg++;
+		else if (*arg)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Parse a cubic region given as "x,y,z,edge".
+ * @param[in] arg The string to parse.
+ * @param[out] region The parsed region.
+ * @return true if the string held four valid values and a non-empty edge,
+ *         false otherwise
+ */
+static bool region_parse(const char* const arg, region_t* const region) {
+	unsigned x, y, z, edge;
+	char end;
+	if (sscanf(arg, "%u,%u,%u,%u%c", &x, &y, &z, &edge, &end) != 4
+		|| x > UINT8_MAX || y > UINT8_MAX || z > UINT8_MAX || !edge || edge > UINT8_MAX)
+		return false;
+	*region = (region_t){ .origin = { (uint8_t)x, (uint8_t)y, (uint8_t)z }, .edge = (uint8_t)edge };
+	return true;
+}
+
+/**
+ * @brief Parse a program of rotation and mirror keys into the symmetry it
+ *        applies.
+ * @param[in] arg The keys, as typed in the interactive mode: w, s, a, d, q,
+ *            and e rotate, and 1, 2, and 3 mirror.
+ * @param[out] program The symmetry of all keys, applied in order.
+ * @return true if every key was a rotation or a mirror, false otherwise
+ */
+static bool program_parse(const char* arg, symmetry_t* const program) {
+	static const char rotations[] = "swadeq";
+	*program = symmetry_identity();
+	for (; *arg; arg++) {
+		const char* const rotation = strchr(rotations, *arg);
+		symmetry_t symmetry;
+		if (rotation) {
+			const axis_t axis = (axis_t)(rotation - rotations);
+			symmetry = symmetry_from_axis(&axis);
+		} else if (*arg >= '1' && *arg <= '3') {
+			symmetry = symmetry_from_mirror((uint8_t)(*arg - '1'));
+		} else {
+			return false;
+		}
+		*program = symmetry_compose(program, &symmetry);
+	}
+	return true;
+}
+
+/**
+ * @brief Parse the command line options.
  * @param[in] argc The number of arguments.
  * @param[in] argv An array of arguments.
- * @param[out] tensor3 The third-order tensor to initialize.
- * @return true if the third-order tensor was initialized, false otherwise
+ * @param[out] options The parsed options.
+ * @return true if the options were parsed successfully, false otherwise
+ *
+ * Usage: 3d [-a fps] [-b rotations] [-B x,y,z,edge] [-c hot_sections]
+ *           [-C channels] [-i raw_file] [-k kernel] [-m metrics_file] [-M]
+ *           [-r degrees] [-s snapshot_file] [-S operations[,seed]]
+ *           [-t channel,...] [-T tune_file] [-V trials[,seed]] [-w workers]
+ *           [-l input_log | -L input_log [-F]] [-j manifest[,threads]]
+ *           [-p program] [-R standby_socket | -H socket] [-g stride]
+ *           dimension
+ *
+ * -a animates rotations at the given number of frames per second.
+ * -b measures the given number of rotations instead of running interactively.
+ * -B selects the cube rotated by the b key; the whole tensor by default.
+ * -c keeps only the given number of recently used sections decompressed.
+ * -C gives every element the given number of channels.
+ * -g starts in the montage view, showing every section whose index is a
+ *    multiple of the given stride; the m key toggles the montage view.
+ * -H runs as a hot standby: waits for a primary to connect to the given Unix
+ *    socket, mirrors its tensor, and takes over the session once the primary
+ *    disconnects; the primary's tensor replaces the dimension, -i, -C, -t,
+ *    and -k. It cannot be combined with -w.
+ * -j applies the program given by -p to every raw volume listed in the given
+ *    manifest, one input and output file per line, with the given number of
+ *    threads per pipeline stage (2 by default), instead of running
+ *    interactively.
+ * -k selects the rotation kernel: quartet (the default), hypercube, or permute.
+ * -l records every byte of keyboard input, with its timing, to the given log.
+ * -L replays the given input log instead of reading the keyboard, at the
+ *    recorded timing, or as fast as possible with -F, and prints timing
+ *    statistics on exit.
+ * -m writes operation counters and latencies to the given file every second.
+ * -M prints the memory allocated for every category on exit.
+ * -p lists the rotation and mirror keys applied to every volume by -j.
+ * -V verifies every kernel against the quartet kernel with the given number
+ *    of random operation sequences, optionally followed by a seed, on
+ *    dimensions up to the given one, instead of running interactively; -C
+ *    fixes the number of channels, which is drawn for every sequence
+ *    otherwise.
+ * -r sets the angle of the resampled rotations; 15 degrees by default.
+ * -R sends the tensor and then every operation of the session to the hot
+ *    standby listening on the given Unix socket.
+ * -S runs the given number of random session operations, optionally followed
+ *    by a seed, on dimensions up to the given one, reporting latency and
+ *    memory drift, instead of running interactively.
+ * -t lists the channels holding intensities rather than symbols.
+ * -T picks the fastest kernel for every axis, reading it from the given cache
+ *    file or measuring it and appending it there; it overrides -k and cannot
+ *    be combined with -c or -w.
+ * -w splits the tensor into slabs owned by the given number of processes,
+ *    at most one per section; it cannot be combined with -c.
  */
-static bool tensor3_init_from_args(
+static bool options_parse(
 	const int* const argc,
 	char** const argv,
-	tensor3_t* const tensor3
+	options_t* const options
 ) {
-	if (*argc != 2)
+	*options = (options_t){ .step_degrees = 15.0, .batch_threads = 2, .batch_program = symmetry_identity() };
+	int opt;
+	while ((opt = getopt(*argc, argv, "a:b:B:c:C:Fg:H:i:j:k:l:L:m:Mp:r:R:s:S:t:T:V:w:")) != -1) {
+		switch (opt) {
+			case 'a':
+				if (!uint8_parse(optarg, &options->animation_fps) || !options->animation_fps)
+					return false;
+				break;
+			case 'b':
+				if (sscanf(optarg, "%u", &options->benchmark_rotations) != 1)
+					return false;
+				break;
+			case 'B':
+				if (!region_parse(optarg, &options->box))
+					return false;
+				break;
+			case 'c':
+				if (!uint8_parse(optarg, &options->hot_sections) || !options->hot_sections)
+					return false;
+				break;
+			case 'C':
+				if (!uint8_parse(optarg, &options->channels)
+					|| !options->channels
+					|| options->channels > TENSOR3_CHANNELS_MAX)
+					return false;
+				break;
+			case 'F':
+				options->replay_fast = true;
+				break;
+			case 'g':
+				if (!uint8_parse(optarg, &options->montage_stride) || !options->montage_stride)
+					return false;
+				break;
+			case 'H':
+				options->standby_path = optarg;
+				break;
+			case 'i':
+				options->import_path = optarg;
+				break;
+			case 'j': {
+				// a trailing number after the last comma is the thread count
+				char* const comma = strrchr(optarg, ',');
+				unsigned threads;
+				char end;
+				if (comma && sscanf(comma + 1, "%u%c", &threads, &end) == 1) {
+					if (!threads || threads > UINT8_MAX)
+						return false;
+					options->batch_threads = (uint8_t)threads;
+					*comma = '\0';
+				}
+				options->batch_manifest = optarg;
+				break;
+			}
+			case 'k':
+				if (!kernel_parse(optarg, &options->kernel))
+					return false;
+				break;
+			case 'l':
+				options->record_path = optarg;
+				break;
+			case 'L':
+				options->replay_path = optarg;
+				break;
+			case 'm':
+				options->metrics_path = optarg;
+				break;
+			case 'M':
+				options->memory_report = true;
+				break;
+			case 'p':
+				if (!program_parse(optarg, &options->batch_program))
+					return false;
+				break;
+			case 'r':
+				if (sscanf(optarg, "%lf", &options->step_degrees) != 1)
+					return false;
+				break;
+			case 'R':
+				options->replica_path = optarg;
+				break;
+			case 's':
+				options->snapshot_path = optarg;
+				break;
+			case 'S': {
+				unsigned long long operations;
+				const int fields = sscanf(optarg, "%llu,%u", &operations, &options->soak_seed);
+				if (fields < 1 || !operations)
+					return false;
+				options->soak_operations = operations;
+				if (fields == 1)
+					options->soak_seed = (uint32_t)time(NULL);
+				break;
+			}
+			case 't':
+				if (!channels_parse(optarg, &options->intensity_channels))
+					return false;
+				break;
+			case 'T':
+				options->tune_path = optarg;
+				break;
+			case 'V': {
+				const int fields = sscanf(optarg, "%u,%u", &options->verify_trials, &options->verify_seed);
+				if (fields < 1 || !options->verify_trials)
+					return false;
+				if (fields == 1)
+					options->verify_seed = (uint32_t)time(NULL);
+				break;
+			}
+			case 'w':
+				if (!uint8_parse(optarg, &options->workers) || !options->workers)
+					return false;
+				break;
+			default:
+				return false;
+		}
+	}
+	if (optind != *argc - 1)
 		return false;
-	if (!uint8_parse(argv[1], &tensor3->dimension))
+	if (!uint8_parse(argv[optind], &options->dimension))
 		return false;
-	if (tensor3->dimension < TENSOR3_DIM_MIN || tensor3->dimension > TENSOR3_DIM_MAX)
+	if (options->workers && (options->hot_sections || options->workers > options->dimension))
 		return false;
-	tensor3->section = 0;
-	tensor3->section_size = tensor3->dimension * tensor3->dimension;
-	tensor3->size = tensor3->section_size * tensor3->dimension;
-	tensor3->buffer = (uint8_t*)malloc(tensor3->size);
-	if (!tensor3->buffer)
+	if (options->tune_path && (options->hot_sections || options->workers))
 		return false;
-	for (int i = 0; i < tensor3->size; i++)
-		tensor3->buffer[i] = (i / tensor3->section_size) % ('Z' - 'A') + 'A';
-	return true;
+	if ((options->record_path && options->replay_path) || (options->replay_fast && !options->replay_path))
+		return false;
+	if (options->replica_path && options->standby_path)
+		return false;
+	// a standby must resize along with its primary, which slabs cannot do
+	if (options->standby_path && options->workers)
+		return false;
+	if (!options->box.edge)
+		options->box.edge = options->dimension;
+	if (options->box.origin.x + options->box.edge > options->dimension
+		|| options->box.origin.y + options->box.edge > options->dimension
+		|| options->box.origin.z + options->box.edge > options->dimension)
+		return false;
+	return options->dimension >= TENSOR3_DIM_MIN && options->dimension <= TENSOR3_DIM_MAX;
+}
+
+/**
+ * @brief Print (a section of a channel of) the third-order tensor to the
+ *        terminal.
+ * @param[in] tensor3 The third-order tensor to render.
+ */
+static void tensor3_render(const tensor3_t* const tensor3) {
+	const uint8_t* plane = tensor3->buffer + tensor3->channel * tensor3->size;
+	for (uint8_t y = 0; y < tensor3->dimension; y++) {
+		for (uint8_t x = 0; x < tensor3->dimension; x++) {
+			const coordinate_t coord = { x, y, tensor3->section };
+			putchar(plane[tensor3_coord_to_index(&coord, tensor3)]);
+		}
+		putchar('\n');
+	}
 }
 
 /**
- * @brief Calculate the index of a third-order tensor given a coordinate.
- * @param[in] coord A coordinate structure to convert to an index.
- * @param[in] tensor3 The third-order tensor to calculate the index for.
- * @return The calculated index.
+ * @brief Print the current section of a third-order tensor to the terminal
+ *        as it appears partway through a rotation.
+ * @param[in] tensor3 The unrotated third-order tensor.
+ * @param[in] matrix The inverse rotation, as built by resample_matrix.
  *
- * Formula: index = x + (y * width) + (z * width * height)
+ * Only the elements of the visible section are sampled, through the same
+ * mapping tensor3_resample applies to the whole tensor.
  */
-static uint32_t tensor3_coord_to_index(
-	const coordinate_t* const coord,
-	const tensor3_t* const tensor3
-) {
-	return coord->x + (coord->y * tensor3->dimension) + (coord->z * tensor3->section_size);
+static void tensor3_render_turning(const tensor3_t* const tensor3, const float matrix[3][3]) {
+	const float center = (tensor3->dimension - 1) / 2.0f;
+	const float offset[3] = { 0, 0, tensor3->section - center };
+	for (uint8_t y = 0; y < tensor3->dimension; y++) {
+		for (uint8_t x = 0; x < tensor3->dimension; x++) {
+			float position[3];
+			for (uint8_t k = 0; k < 3; k++)
+				position[k] = center
+					+ matrix[k][0] * (x - center)
+					+ matrix[k][1] * (y - center)
+					+ matrix[k][2] * offset[2];
+			putchar(tensor3_sample(tensor3, position));
+		}
+		putchar('\n');
+	}
 }
 
 /**
- * @brief Convert an index to a corresponding coordinate.
- * @param[out] coord The coordinate to calculate.
- * @param[in] idx The index to convert into a coordinate.
- * @param[in] tensor3 The third-order tensor to calculate the coordinate for.
- * @return true if the conversion was successful, false otherwise
+ * @brief Allocate the frame buffer of the montage view.
+ * @param[out] montage The montage view to set up.
+ * @param[in] stride The stride given by -g, or 0 to start with the montage
+ *            view off and a stride of 1.
+ * @return true if the frame buffer was allocated, false otherwise
  *
- * Every time the index increases by one width, the x value resets.
- * x = index % width
+ * The buffer holds the largest frame: clearing the screen, then every tile
+ * of a tensor of TENSOR3_DIM_MAX at stride 1, each line of a tile preceded
+ * by a cursor movement.
+ */
+static bool montage_init(montage_t* const montage, const uint8_t stride) {
+	*montage = (montage_t){ .enabled = stride != 0, .stride = stride ? stride : 1 };
+	const size_t width = TENSOR3_DIM_MAX > MONTAGE_LABEL_WIDTH ? TENSOR3_DIM_MAX : MONTAGE_LABEL_WIDTH;
+	montage->capacity = 2 * MONTAGE_MOVE_MAX
+		+ (size_t)TENSOR3_DIM_MAX * (TENSOR3_DIM_MAX + 1) * (MONTAGE_MOVE_MAX + width);
+	montage->frame = (char*)malloc(montage->capacity);
+	return montage->frame != NULL;
+}
+
+/**
+ * @brief Free the frame buffer of the montage view.
+ * @param[in,out] montage The montage view.
+ */
+static void montage_free(montage_t* const montage) {
+	free(montage->frame);
+	montage->frame = NULL;
+}
+
+/**
+ * @brief Draw the montage view of a third-order tensor: every stride-th
+ *        section of the current channel in a grid as wide as the terminal.
+ * @param[in,out] montage The montage view.
+ * @param[in,out] tensor3 The third-order tensor to render.
+ * @return The number of bytes written to the terminal.
  *
- * When the index increases by one width, the height increases by one. Once the
- * index increases by width times height, the y value resets.
- * y = (index / width) % height
+ * Each tile is labelled with its section, starred if it is the current one.
+ * The whole frame is assembled in the montage's buffer and written at once.
+ * If the previous frame is still on screen and the layout is unchanged, only
+ * the tiles whose checksum or x-axis and y-axis origins changed are redrawn,
+ * so unchanged cold sections are not even thawed, along with the labels
+ * whose current mark changed.
+ */
+static size_t tensor3_render_montage(montage_t* const montage, tensor3_t* const tensor3) {
+	const uint8_t dimension = tensor3->dimension;
+	const uint8_t width = dimension > MONTAGE_LABEL_WIDTH ? dimension : MONTAGE_LABEL_WIDTH;
+	const uint16_t columns = (terminal_columns() + 1) / (width + 1);
+	const uint8_t per_row = !columns ? 1 : columns > UINT8_MAX ? UINT8_MAX : (uint8_t)columns;
+	if (montage->dimension != dimension || montage->channel != tensor3->channel || montage->columns != per_row) {
+		montage->dimension = dimension;
+		montage->channel = tensor3->channel;
+		montage->columns = per_row;
+		montage->valid = false;
+	}
+	char* out = montage->frame;
+	if (!montage->valid)
+		out += sprintf(out, "\x1b[2J");
+	const uint8_t* const plane = tensor3->buffer + tensor3->channel * tensor3->size;
+	uint16_t rows = 0;
+	for (uint16_t z = 0, tile = 0; z < dimension; z += montage->stride, tile++) {
+		// the tile shows the section wherever the z-axis origin put it
+		const uint8_t section = (z + tensor3->origin[2]) % dimension;
+		const montage_tile_t shown = {
+			.checksum = tensor3->checksums ? tensor3->checksums[tensor3->channel * dimension + section] : 0,
+			.origin = { tensor3->origin[0], tensor3->origin[1] },
+			.current = z == tensor3->section
+		};
+		const uint16_t top = 1 + tile / per_row * (dimension + 1);
+		const uint16_t left = 1 + tile % per_row * (width + 1);
+		rows = top + dimension;
+		const montage_tile_t* const drawn = &montage->tiles[tile];
+		const bool changed = !montage->valid
+			|| !tensor3->checksums
+			|| drawn->checksum != shown.checksum
+			|| drawn->origin[0] != shown.origin[0]
+			|| drawn->origin[1] != shown.origin[1];
+		if (!changed && drawn->current == shown.current)
+			continue;
+		if (changed && !tensor3_section_touch(tensor3, &section))
+			continue;
+		montage->tiles[tile] = shown;
+		// the current section is marked with a star after its index
+		char label[sizeof("z255*")];
+		snprintf(label, sizeof(label), "z%u%s", z, shown.current ? "*" : "");
+		out += sprintf(out, "\x1b[%u;%uH%-*s", top, left, width, label);
+		// moving the current section only redraws the labels
+		for (uint8_t y = 0; changed && y < dimension; y++) {
+			out += sprintf(out, "\x1b[%u;%uH", top + 1 + y, left);
+			for (uint8_t x = 0; x < dimension; x++) {
+				const coordinate_t coord = { x, y, z };
+				*out++ = plane[tensor3_coord_to_index(&coord, tensor3)];
+			}
+		}
+	}
+	// park the cursor below the grid
+	out += sprintf(out, "\x1b[%u;1H", rows + 1);
+	montage->valid = true;
+	fflush(stdout);
+	size_t size = out - montage->frame;
+	const char* data = montage->frame;
+	while (size) {
+		const ssize_t written = write(STDOUT_FILENO, data, size);
+		if (written <= 0)
+			break;
+		data += written;
+		size -= written;
+	}
+	return out - montage->frame;
+}
+
+/**
+ * @brief Show the current section of a third-order tensor turning through
+ *        the intermediate angles of a rotation.
+ * @param[in,out] tensor3 The third-order tensor about to be rotated.
+ * @param[in] axis The axis of the rotation.
+ * @param[in] degrees The angle of the rotation.
+ * @param[in] fps The target number of frames per second.
  *
- * As the index increases by width times height, the z value increases by one.
- * z = index / (width * height)
+ * The animation lasts ANIMATION_SECONDS and leaves the tensor unchanged;
+ * the rotation itself is committed afterwards.
  */
-[[maybe_unused]] static bool tensor3_index_to_coord(
-	coordinate_t* const coord,
-	const uint32_t* const idx,
-	const tensor3_t* const tensor3
+static void tensor3_animate(
+	tensor3_t* const tensor3,
+	const axis_t* const axis,
+	const double* const degrees,
+	const uint8_t* const fps
 ) {
-	if (*idx >= tensor3->size)
-		return false;
-	coord->x = *idx % tensor3->dimension;
-	coord->y = (*idx / tensor3->dimension) % tensor3->dimension;
-	coord->z = *idx / tensor3->section_size;
-	return true;
+	if (!tensor3_thaw_all(tensor3))
+		return;
+	const uint32_t frames = (uint32_t)(*fps * ANIMATION_SECONDS);
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	for (uint32_t frame = 1; frame < frames; frame++) {
+		const double angle = *degrees * frame / frames;
+		float matrix[3][3];
+		resample_matrix(matrix, axis, &angle);
+		terminal_clear();
+		tensor3_render_turning(tensor3, matrix);
+		fflush(stdout);
+		deadline.tv_nsec += 1000000000L / *fps;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+	}
 }
 
 /**
- * @brief Calculate a quartet of coordinates to rotate in a third-order tensor.
- * @param[out] quartet The quartet of coordinates under calculation.
- * @param[in] tensor3 The third-order tensor to calculate the quartet of.
- * @param[in] section The section of the tensor to calculate the quartet for.
- * @param[in] layer The layer within the section.
- * @param[in] offset The offset within the layer.
- * @param[in] axis The axis to rotate about.
- * @return true if the calculation was successful, false otherwise
+ * @brief Apply an operation to a third-order tensor and send it to the hot
+ *        standby, if any.
+ * @param[in,out] tensor3 The third-order tensor to operate on.
+ * @param[in,out] replica The hot standby.
+ * @param[in] record The operation to apply.
+ * @param[in] path The snapshot file of a snapshot load, or NULL.
+ * @return The result of the operation.
+ *
+ * Once REPLICA_HASH_INTERVAL records have been sent, the hash of the tensor
+ * is sent along with the first one leaving no symmetries queued, for the
+ * standby to check itself against. Failed operations are not sent, as the
+ * standby stops on any record failing to apply; the hash is sent as soon as
+ * possible after them instead, in case they changed the tensor partway.
  */
-static bool tensor3_calculate_quartet(
+static bool tensor3_record(
 	tensor3_t* const tensor3,
-	quartet_t* const quartet,
-	const uint8_t* const section,
-	const uint8_t* const layer,
-	const uint8_t* const offset,
-	const axis_t* const axis
+	replica_t* const replica,
+	const oplog_record_t* const record,
+	const char* const path
 ) {
-	if (*section >= tensor3->dimension
-		|| *layer >= tensor3->section_size / 2
-		|| *offset >= tensor3->dimension - 1 - 2 * *layer)
-		return false;
-	switch (*axis) {
-		case AXIS_XPOSITIVE:
-			*quartet = (quartet_t){
-				.first = (coordinate_t){
-					.x = *section,
-					.y = *layer,
-					.z = tensor3->dimension - 1 - *layer - *offset
-				},
-				.second = (coordinate_t){
-					.x = *section,
-					.y = *layer + *offset,
-					.z = *layer
-				},
-				.third = (coordinate_t){
-					.x = *section,
-					.y = tensor3->dimension - 1 - *layer,
-					.z = *layer + *offset
-				},
-				.fourth = (coordinate_t){
-					.x = *section,
-					.y = tensor3->dimension - 1 - *layer - *offset,
-					.z = tensor3->dimension - 1 - *layer
-				}
-			};
-			break;
-		case AXIS_XNEGATIVE:
-			*quartet = (quartet_t){
-				.first = (coordinate_t){
-					.x = tensor3->dimension - 1 - *section,
-					.y = *layer,
-					.z = *layer + *offset
-				},
-				.second = (coordinate_t){
-					.x = tensor3->dimension - 1 - *section,
-					.y = *layer + *offset,
-					.z = tensor3->dimension - 1 - *layer
-				},
-				.third = (coordinate_t){
-					.x = tensor3->dimension - 1 - *section,
-					.y = tensor3->dimension - 1 - *layer,
-					.z = tensor3->dimension - 1 - *layer - *offset
-				},
-				.fourth = (coordinate_t){
-					.x = tensor3->dimension - 1 - *section,
-					.y = tensor3->dimension - 1 - *layer - *offset,
-					.z = *layer
-				}
-			};
-			break;
-		case AXIS_YPOSITIVE:
-			*quartet = (quartet_t){
-				.first = (coordinate_t){
-					.x = *layer + *offset,
-					.y = *section,
-					.z = tensor3->dimension - 1 - *layer
-				},
-				.second = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer,
-					.y = *section,
-					.z = tensor3->dimension - 1 - *layer - *offset
-				},
-				.third = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer - *offset,
-					.y = *section,
-					.z = *layer
-				},
-				.fourth = (coordinate_t){
-					.x = *layer,
-					.y = *section,
-					.z = *layer + *offset
-				},
-			};
-			break;
-		case AXIS_YNEGATIVE:
-			*quartet = (quartet_t){
-				.first = (coordinate_t){
-					.x = *layer + *offset,
-					.y = tensor3->dimension - 1 - *section,
-					.z = *layer
-				},
-				.second = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer,
-					.y = tensor3->dimension - 1 - *section,
-					.z = *layer + *offset
-				},
-				.third = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer - *offset,
-					.y = tensor3->dimension - 1 - *section,
-					.z = tensor3->dimension - 1 - *layer
-				},
-				.fourth = (coordinate_t){
-					.x = *layer,
-					.y = tensor3->dimension - 1 - *section,
-					.z = tensor3->dimension - 1 - *layer - *offset
-				}
-			};
-			break;
-		case AXIS_ZPOSITIVE:
-			*quartet = (quartet_t){
-				.first = (coordinate_t){
-					.x = *layer + *offset,
-					.y = *layer,
-					.z = *section
-				},
-				.second = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer,
-					.y = *layer + *offset,
-					.z = *section
-				},
-				.third = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer - *offset,
-					.y = tensor3->dimension - 1 - *layer,
-					.z = *section
-				},
-				.fourth = (coordinate_t){
-					.x = *layer,
-					.y = tensor3->dimension - 1 - *layer - *offset,
-					.z = *section
-				}
-			};
-			break;
-		case AXIS_ZNEGATIVE:
-			*quartet = (quartet_t){
-				.first = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer - *offset,
-					.y = *layer,
-					.z = tensor3->dimension - 1 - *section
-				},
-				.second = (coordinate_t){
-					.x = *layer,
-					.y = *layer + *offset,
-					.z = tensor3->dimension - 1 - *section
-				},
-				.third = (coordinate_t){
-					.x = *layer + *offset,
-					.y = tensor3->dimension - 1 - *layer,
-					.z = tensor3->dimension - 1 - *section
-				},
-				.fourth = (coordinate_t){
-					.x = tensor3->dimension - 1 - *layer,
-					.y = tensor3->dimension - 1 - *layer - *offset,
-					.z = tensor3->dimension - 1 - *section
-				},
-			};
-			break;
-		default:
-			return false;
+	const symmetry_t identity = symmetry_identity();
+	// flushing nothing is not worth a record
+	const bool idle = record->kind == OPLOG_FLUSH && symmetry_equal(&tensor3->pending, &identity);
+	const bool result = oplog_apply(tensor3, record, path);
+	if (replica->fd < 0 || idle)
+		return result;
+	bool sent = true;
+	if (result) {
+		sent = replica_send(replica->fd, record, path);
+		replica->records++;
+	} else {
+		replica->records = REPLICA_HASH_INTERVAL;
 	}
-	return true;
+	if (sent && replica->records >= REPLICA_HASH_INTERVAL && symmetry_equal(&tensor3->pending, &identity)) {
+		const oplog_record_t check = { .kind = OPLOG_HASH, .hash = tensor3_hash(tensor3) };
+		sent = replica_send(replica->fd, &check, NULL);
+		replica->records = 0;
+	}
+	if (!sent) {
+		fprintf(stderr, "standby lost; no longer replicating\n");
+		close(replica->fd);
+		replica->fd = -1;
+	}
+	return result;
 }
 
 /**
- * @brief Rotate a quartet of coordinates in a layer of a third-order tensor.
- * @param[in,out] tensor3 The third-order tensor being rotated.
- * @param[in] section The section being rotated.
- * @param[in] layer The layer being rotated.
- * @param[in] offset The offset within the layer used to calculate the quartet.
+ * @brief Rotate a third-order tensor in response to a key, animating the
+ *        rotation if requested.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] options The command line options.
+ * @param[in,out] replica The hot standby to send the rotation to.
  * @param[in] axis The axis to rotate about.
+ * @param[in] resample Whether to rotate by the angle given by -r instead of 90
+ *            degrees.
  * @return true if the rotation was successful, false otherwise
+ *
+ * Unanimated 90 degree rotations are queued, to be folded together with the
+ * symmetries of any keys typed ahead.
  */
-static bool tensor3_rotate_quartet(
+static bool tensor3_turn(
 	tensor3_t* const tensor3,
-	const uint8_t* const section,
-	const uint8_t* const layer,
-	const uint8_t* const offset,
-	const axis_t* const axis
+	const options_t* const options,
+	replica_t* const replica,
+	const axis_t axis,
+	const bool resample
 ) {
-	quartet_t quartet = { 0 };
-	if (!tensor3_calculate_quartet(tensor3, &quartet, section, layer, offset, axis))
+	if (!resample && !options->animation_fps) {
+		const oplog_record_t queue = { .kind = OPLOG_QUEUE, .symmetry = symmetry_from_axis(&axis) };
+		return tensor3_record(tensor3, replica, &queue, NULL);
+	}
+	const oplog_record_t flush = { .kind = OPLOG_FLUSH };
+	if (!tensor3_record(tensor3, replica, &flush, NULL))
 		return false;
-	uint32_t first_idx = tensor3_coord_to_index(&quartet.first, tensor3);
-	uint32_t second_idx = tensor3_coord_to_index(&quartet.second, tensor3);
-	uint32_t third_idx = tensor3_coord_to_index(&quartet.third, tensor3);
-	uint32_t fourth_idx = tensor3_coord_to_index(&quartet.fourth, tensor3);
-	char first = tensor3->buffer[first_idx];
-	char second = tensor3->buffer[second_idx];
-	char third = tensor3->buffer[third_idx];
-	char fourth = tensor3->buffer[fourth_idx];
-	tensor3->buffer[first_idx] = fourth;
-	tensor3->buffer[second_idx] = first;
-	tensor3->buffer[third_idx] = second;
-	tensor3->buffer[fourth_idx] = third;
-	return true;
+	const double degrees = resample ? options->step_degrees : 90.0;
+	if (options->animation_fps)
+		tensor3_animate(tensor3, &axis, &degrees, &options->animation_fps);
+	const oplog_record_t rotation = {
+		.kind = resample ? OPLOG_ROTATE_ANGLE : OPLOG_ROTATE,
+		.axis = (uint8_t)axis,
+		.degrees = degrees
+	};
+	return tensor3_record(tensor3, replica, &rotation, NULL);
 }
 
 /**
- * @brief Rotate a layer of a cross section of a third-order tensor 90 degrees.
- * @param[in,out] tensor3 The third-order tensor being rotated.
- * @param[in] section The section being rotated.
- * @param[in] layer The layer to rotate.
- * @param[in] axis The axis to rotate about.
- * @return true if the rotation was successful, false otherwise
+ * @brief Measure the time elapsed since the start of the input session.
+ * @param[in] input The input source.
+ * @return The elapsed time in nanoseconds.
  */
-static bool tensor3_rotate_layer(
-	tensor3_t* const tensor3,
-	const uint8_t* const section,
-	const uint8_t* const layer,
-	const axis_t* const axis
-) {
-	const uint8_t offset_end = tensor3->dimension - 1 - 2 * *layer;
-	for (uint8_t offset = 0; offset < offset_end; offset++)
-		if (!tensor3_rotate_quartet(tensor3, section, layer, &offset, axis))
-			return false;
-	return true;
+static uint64_t input_clock(const input_t* const input) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)(now.tv_sec - input->start.tv_sec) * 1000000000u + now.tv_nsec - input->start.tv_nsec;
 }
 
 /**
- * @brief Rotate a cross section of a third-order tensor 90 degrees.
- * @param[in,out] tensor3 The third-order tensor being rotated.
- * @param[in] section The section to rotate.
- * @param[in] axis The axis to rotate about.
- * @return true if the rotation was successful, false otherwise
+ * @brief Read the next record of a replayed input log.
+ * @param[in,out] input The input source replaying a log.
+ *
+ * Once the log runs out, or a record is truncated, no more input is
+ * available.
  */
-static bool tensor3_rotate_section(
-	tensor3_t* const tensor3,
-	const uint8_t* const section,
-	const axis_t* const axis
-) {
-	for (uint8_t layer = 0; layer < tensor3->dimension / 2; layer++)
-		if (!tensor3_rotate_layer(tensor3, section, &layer, axis))
+static void input_advance(input_t* const input) {
+	uint32_t delta;
+	input->available = fread(&delta, sizeof(delta), 1, input->replay) == 1
+		&& fread(&input->next, 1, 1, input->replay) == 1;
+	if (input->available)
+		input->due += (uint64_t)delta * 1000;
+}
+
+/**
+ * @brief Open the input source selected by the command line options.
+ * @param[out] input The input source to open.
+ * @param[in] options The command line options.
+ * @return true if the input log could be opened, false otherwise
+ */
+static bool input_open(input_t* const input, const options_t* const options) {
+	*input = (input_t){ .fast = options->replay_fast };
+	char magic[sizeof(INPUT_MAGIC) - 1];
+	if (options->record_path) {
+		input->record = fopen(options->record_path, "wb");
+		if (!input->record || fwrite(INPUT_MAGIC, sizeof(magic), 1, input->record) != 1) {
+			perror(options->record_path);
+			return false;
+		}
+	} else if (options->replay_path) {
+		input->replay = fopen(options->replay_path, "rb");
+		if (!input->replay
+			|| fread(magic, sizeof(magic), 1, input->replay) != 1
+			|| memcmp(magic, INPUT_MAGIC, sizeof(magic))) {
+			fprintf(stderr, "%s: not an input log\n", options->replay_path);
 			return false;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &input->start);
+	if (input->replay)
+		input_advance(input);
 	return true;
 }
 
 /**
- * @brief Rotate a third-order tensor 90 degrees.
- * @param[in,out] tensor3 The third-order tensor to rotate.
- * @param[in] axis The axis to rotate about.
- * @return true if the rotation was successful, false otherwise
+ * @brief Close an input source, printing the timing statistics of a replay.
+ * @param[in,out] input The input source to close.
+ */
+static void input_close(input_t* const input) {
+	if (input->record)
+		fclose(input->record);
+	if (!input->replay)
+		return;
+	fclose(input->replay);
+	const uint32_t count = input->count ? input->count : 1;
+	fprintf(
+		stderr,
+		"replayed %u inputs in %.3f s, recorded over %.3f s\n"
+		"handling: mean %.3f ms, max %.3f ms\n"
+		"lateness: mean %.3f ms, max %.3f ms\n",
+		input->count,
+		input->delivered / 1e9,
+		input->due / 1e9,
+		input->handling_total / 1e6 / count,
+		input->handling_max / 1e6,
+		input->late_total / 1e6 / count,
+		input->late_max / 1e6
+	);
+}
+
+/**
+ * @brief Read a byte of input, waiting for it if necessary.
+ * @param[in,out] input The input source.
+ * @param[out] c The byte read.
+ * @return true if a byte was read, false at the end of the input
+ *
+ * Bytes read from the terminal are appended to the log being recorded. A
+ * replay waits until the recorded time of the byte unless it runs fast; the
+ * time since the previous byte was delivered counts as handling it.
  */
-static bool tensor3_rotate(tensor3_t* const tensor3, const axis_t axis) {
-	for (uint8_t section = 0; section < tensor3->dimension; section++) 
-		if (!tensor3_rotate_section(tensor3, &section, &axis))
+static bool input_read(input_t* const input, char* const c) {
+	if (!input->replay) {
+		if (read(STDIN_FILENO, c, 1) <= 0)
 			return false;
+		if (input->record) {
+			const uint64_t now = input_clock(input);
+			const uint64_t micros = (now - input->last) / 1000;
+			const uint32_t delta = micros > UINT32_MAX ? UINT32_MAX : (uint32_t)micros;
+			input->last += (uint64_t)delta * 1000;
+			fwrite(&delta, sizeof(delta), 1, input->record);
+			fwrite(c, 1, 1, input->record);
+			fflush(input->record);
+		}
+		return true;
+	}
+	if (!input->available)
+		return false;
+	uint64_t now = input_clock(input);
+	if (input->count) {
+		const uint64_t handling = now - input->delivered;
+		input->handling_total += handling;
+		if (handling > input->handling_max)
+			input->handling_max = handling;
+	}
+	if (!input->fast && now < input->due) {
+		const uint64_t due = (uint64_t)input->start.tv_nsec + input->due;
+		const struct timespec deadline = {
+			.tv_sec = input->start.tv_sec + (time_t)(due / 1000000000u),
+			.tv_nsec = (long)(due % 1000000000u)
+		};
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL))
+			;
+		now = input_clock(input);
+	}
+	if (!input->fast) {
+		const uint64_t late = now - input->due;
+		input->late_total += late;
+		if (late > input->late_max)
+			input->late_max = late;
+	}
+	*c = (char)input->next;
+	input->count++;
+	input->delivered = now;
+	input_advance(input);
 	return true;
 }
 
+/**
+ * @brief Check whether more input is waiting to be read.
+ * @param[in] input The input source.
+ * @return true if a read would not block, false otherwise
+ *
+ * A replayed byte is waiting once its recorded time has come, or at once if
+ * the replay runs fast.
+ */
+static bool input_pending(const input_t* const input) {
+	if (input->replay)
+		return input->available && (input->fast || input->due <= input_clock(input));
+	struct pollfd terminal = { .fd = STDIN_FILENO, .events = POLLIN };
+	return poll(&terminal, 1, 0) > 0;
+}
+
 /**
  * @brief Process keyboard input.
  * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] options The command line options.
+ * @param[in,out] input The input source to read the keys from.
+ * @param[in,out] replica The hot standby to send the operations to.
+ * @param[in,out] montage The montage view, toggled by the m key.
  * @return true if the input was processed successfully, false otherwise.
+ *
+ * Every change to the tensor or the view of it goes through tensor3_record.
  */
-static bool tensor3_process_input(tensor3_t* const tensor3) {
+static bool tensor3_process_input(
+	tensor3_t* const tensor3,
+	const options_t* const options,
+	input_t* const input,
+	replica_t* const replica,
+	montage_t* const montage
+) {
 	char c;
-	if (read(STDIN_FILENO, &c, 1) <= 0)
+	if (!input_read(input, &c))
 		return false;
+	// animations draw over the montage
+	if (options->animation_fps && c && strchr("wsadqeWSADQE", c))
+		montage->valid = false;
+	const bool symmetry = strchr("wsadqe123", c) != NULL;
+	static const char shifts[] = "hljkui";
+	const char* const shift = c ? strchr(shifts, c) : NULL;
+	const oplog_record_t flush = { .kind = OPLOG_FLUSH };
+	if (!symmetry)
+		tensor3_record(tensor3, replica, &flush, NULL);
 	switch (c) {
 		case 'x':
 			// quit; currently, returning false will terminate the program
 			return false;
 		case 'w':
-			tensor3_rotate(tensor3, AXIS_XNEGATIVE);
+			tensor3_turn(tensor3, options, replica, AXIS_XNEGATIVE, false);
 			break;
 		case 's':
-			tensor3_rotate(tensor3, AXIS_XPOSITIVE);
+			tensor3_turn(tensor3, options, replica, AXIS_XPOSITIVE, false);
 			break;
 		case 'a':
-			tensor3_rotate(tensor3, AXIS_YPOSITIVE);
+			tensor3_turn(tensor3, options, replica, AXIS_YPOSITIVE, false);
 			break;
 		case 'd':
-			tensor3_rotate(tensor3, AXIS_YNEGATIVE);
+			tensor3_turn(tensor3, options, replica, AXIS_YNEGATIVE, false);
 			break;
 		case 'q':
-			tensor3_rotate(tensor3, AXIS_ZNEGATIVE);
+			tensor3_turn(tensor3, options, replica, AXIS_ZNEGATIVE, false);
 			break;
 		case 'e':
-			tensor3_rotate(tensor3, AXIS_ZPOSITIVE);
+			tensor3_turn(tensor3, options, replica, AXIS_ZPOSITIVE, false);
+			break;
+		// upper case rotates about the same axis by the angle given by -r
+		case 'W':
+			tensor3_turn(tensor3, options, replica, AXIS_XNEGATIVE, true);
+			break;
+		case 'S':
+			tensor3_turn(tensor3, options, replica, AXIS_XPOSITIVE, true);
+			break;
+		case 'A':
+			tensor3_turn(tensor3, options, replica, AXIS_YPOSITIVE, true);
+			break;
+		case 'D':
+			tensor3_turn(tensor3, options, replica, AXIS_YNEGATIVE, true);
+			break;
+		case 'Q':
+			tensor3_turn(tensor3, options, replica, AXIS_ZNEGATIVE, true);
+			break;
+		case 'E':
+			tensor3_turn(tensor3, options, replica, AXIS_ZPOSITIVE, true);
+			break;
+		// mirror along the x-axis, y-axis, or z-axis
+		case '1':
+		case '2':
+		case '3': {
+			const oplog_record_t mirror = { .kind = OPLOG_QUEUE, .symmetry = symmetry_from_mirror(c - '1') };
+			tensor3_record(tensor3, replica, &mirror, NULL);
+			break;
+		}
+		case 'c': {
+			const oplog_record_t channel = { .kind = OPLOG_CHANNEL, .value = (tensor3->channel + 1) % tensor3->channels };
+			tensor3_record(tensor3, replica, &channel, NULL);
+			break;
+		}
+		// shift cyclically along the x-axis, y-axis, or z-axis
+		case 'h':
+		case 'l':
+		case 'j':
+		case 'k':
+		case 'u':
+		case 'i': {
+			const oplog_record_t shifted = {
+				.kind = OPLOG_SHIFT,
+				.axis = (shift - shifts) / 2,
+				.distance = (shift - shifts) % 2 ? 1 : -1
+			};
+			tensor3_record(tensor3, replica, &shifted, NULL);
+			break;
+		}
+		// switch between the montage view and the current section alone
+		case 'm':
+			montage->enabled = !montage->enabled;
+			montage->valid = false;
+			break;
+		// check every section against its checksums, reporting failures on stderr
+		case 'v':
+			tensor3_check(tensor3);
+			break;
+		case 'n': {
+			const oplog_record_t normalize = { .kind = OPLOG_NORMALIZE };
+			tensor3_record(tensor3, replica, &normalize, NULL);
+			break;
+		}
+		// grow or shrink the tensor by one along every axis
+		case '+':
+		case '-': {
+			const oplog_record_t resize = { .kind = OPLOG_RESIZE, .value = tensor3->dimension + (c == '+' ? 1 : -1) };
+			tensor3_record(tensor3, replica, &resize, NULL);
 			break;
+		}
+		// b followed by a rotation key rotates only the cube given by -B
+		case 'b': {
+			static const char keys[] = "swadeq";
+			char key;
+			const char* const found = input_read(input, &key) && key ? strchr(keys, key) : NULL;
+			if (found) {
+				const oplog_record_t box = { .kind = OPLOG_ROTATE_BOX, .axis = found - keys, .region = options->box };
+				tensor3_record(tensor3, replica, &box, NULL);
+			}
+			break;
+		}
+		// snapshots are saved to and loaded from the file given by -s
+		case 'p':
+			if (options->snapshot_path)
+				tensor3_snapshot_save(tensor3, options->snapshot_path);
+			break;
+		case 'o':
+		case 'O': {
+			// the standby loads the same file, so only its path is sent
+			const oplog_record_t load = {
+				.kind = c == 'o' ? OPLOG_SNAPSHOT_LOAD : OPLOG_SNAPSHOT_LOAD_SECTION,
+				.value = tensor3->section
+			};
+			if (options->snapshot_path)
+				tensor3_record(tensor3, replica, &load, options->snapshot_path);
+			break;
+		}
 		// UP and DOWN arrow keys are used to move sections
 		case '\x1b': { // ANSI escape code
-			getchar(); // skip [
-			char value = getchar();
+			char bracket, value;
+			if (!input_read(input, &bracket) || !input_read(input, &value)) // skip [
+				break;
+			oplog_record_t section = { .kind = OPLOG_SECTION, .value = tensor3->section };
 			if (value == 'A' && tensor3->section < tensor3->dimension - 1)
-				tensor3->section++;
+				section.value++;
 			else if (value == 'B' && tensor3->section > 0)
-				tensor3->section--;
+				section.value--;
+			else
+				break;
+			tensor3_record(tensor3, replica, &section, NULL);
 			break;
 		}
 	}
+	if (symmetry && !input_pending(input))
+		tensor3_record(tensor3, replica, &flush, NULL);
 	return true;
 }
 
-/**
- * @brief Print (a section of) the third-order tensor to the terminal.
- * @param[in] tensor3 The third-order tensor to render.
- */
-static void tensor3_render(const tensor3_t* const tensor3) {
-	const coordinate_t coord = {0, 0, tensor3->section};
-	const uint16_t index_start = tensor3_coord_to_index(&coord, tensor3);
-	const uint16_t index_end = (tensor3->section + 1) * tensor3->section_size;
-	for (uint16_t i = index_start; i < index_end && i < tensor3->size; i++) {
-		putchar(tensor3->buffer[i]);
-		if (i % tensor3->dimension == tensor3->dimension - 1)
-			putchar('\n');
-	}
-}
-
 int main(int argc, char** argv) {
+	options_t options;
+	if (!options_parse(&argc, argv, &options)) {
+		fprintf(stderr, "usage: %s [-a fps] [-b rotations] [-B x,y,z,edge] [-c hot_sections] [-C channels] [-i raw_file] [-k kernel] [-m metrics_file] [-M] [-r degrees] [-s snapshot_file] [-S operations[,seed]] [-t channel,...] [-T tune_file] [-V trials[,seed]] [-w workers] [-l input_log | -L input_log [-F]] [-j manifest[,threads]] [-p program] [-R standby_socket | -H socket] [-g stride] dimension\n", argv[0]);
+		return 1;
+	}
+	if (options.verify_trials)
+		return !tensor3_verify(options.verify_trials, options.verify_seed, options.dimension, options.channels);
+	const tensor3_config_t config = {
+		.dimension = options.dimension,
+		.channels = options.channels,
+		.intensity_channels = options.intensity_channels,
+		.kernel = options.kernel,
+		.import_path = options.import_path,
+		.hot_sections = options.hot_sections,
+		.workers = options.workers,
+		.metrics_path = options.metrics_path
+	};
+	if (options.batch_manifest) {
+		const bool result = tensor3_batch(&config, options.batch_manifest, &options.batch_program, options.batch_threads);
+		if (options.memory_report)
+			memory_report(stderr);
+		return !result;
+	}
+	if (options.soak_operations) {
+		const bool result = tensor3_soak(&config, options.soak_operations, options.soak_seed);
+		if (options.memory_report)
+			memory_report(stderr);
+		return !result;
+	}
 	tensor3_t tensor3;
-	if (!tensor3_init_from_args(&argc, argv, &tensor3))
+	if (!(options.standby_path ? tensor3_standby(&tensor3, &config, options.standby_path) : tensor3_init(&tensor3, &config)))
+		return 1;
+	if (options.tune_path && !tensor3_plan(&tensor3, options.tune_path))
 		return 1;
+	if (options.benchmark_rotations) {
+		const bool result = tensor3_benchmark(&tensor3, &options.benchmark_rotations);
+		tensor3_free(&tensor3);
+		if (options.memory_report)
+			memory_report(stderr);
+		return !result;
+	}
+	replica_t replica = { .fd = options.replica_path ? replica_connect(&tensor3, options.replica_path) : -1 };
+	if (options.replica_path && replica.fd < 0) {
+		fprintf(stderr, "%s: could not sync the standby\n", options.replica_path);
+		tensor3_free(&tensor3);
+		return 1;
+	}
+	input_t input;
+	montage_t montage;
+	if (!montage_init(&montage, options.montage_stride) || !input_open(&input, &options)) {
+		montage_free(&montage);
+		if (replica.fd >= 0)
+			close(replica.fd);
+		tensor3_free(&tensor3);
+		return 1;
+	}
 	struct termios orig_terminal = terminal_init();
+	const symmetry_t identity = symmetry_identity();
 	do {
+		// queued symmetries are applied once the keys typed ahead are read
+		if (!symmetry_equal(&tensor3.pending, &identity))
+			continue;
+		struct timespec start;
+		if (montage.enabled) {
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			const size_t bytes = tensor3_render_montage(&montage, &tensor3);
+			metrics_observe(tensor3.metrics, OPERATION_RENDER, &start, bytes);
+			continue;
+		}
+		// the displayed section lies wherever the z-axis origin puts it
+		const uint8_t section = (tensor3.section + tensor3.origin[2]) % tensor3.dimension;
+		tensor3_section_touch(&tensor3, &section);
+		clock_gettime(CLOCK_MONOTONIC, &start);
 		terminal_clear();
 		tensor3_render(&tensor3);
-	} while (tensor3_process_input(&tensor3));
+		metrics_observe(tensor3.metrics, OPERATION_RENDER, &start, 0);
+	} while (tensor3_process_input(&tensor3, &options, &input, &replica, &montage));
 	terminal_set(&orig_terminal);
+	input_close(&input);
+	montage_free(&montage);
+	if (replica.fd >= 0)
+		close(replica.fd);
+	tensor3_free(&tensor3);
+	if (options.memory_report)
+		memory_report(stderr);
 	return 0;
 }
 
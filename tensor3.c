@@ -0,0 +1,4823 @@
+/**
+ * @file tensor3.c
+ * @brief The engine rotating third-order tensors, as declared in tensor3.h.
+ * @author Justin Thoreson
+ */
+
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <malloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+#include "tensor3.h"
+
+/**
+ * @brief The program's minimum allowed dimension for a third-order tensor.
+ */
+const uint8_t TENSOR3_DIM_MIN = 3;
+
+/**
+ * @brief The program's maximum allowed dimension for a third-order tensor.
+ */
+const uint8_t TENSOR3_DIM_MAX = 50;
+
+/**
+ * @brief The maximum number of worker threads used by parallel operations.
+ */
+#define PARALLEL_THREADS_MAX 16
+
+/**
+ * @brief The maximum rank of a hypercube.
+ */
+#define HYPERCUBE_RANK_MAX 8
+
+/**
+ * @brief The edge length of the square tiles of a section resampled together.
+ */
+#define RESAMPLE_TILE 16
+
+/**
+ * @brief The symbol of positions resampled from outside a tensor.
+ */
+#define RESAMPLE_SYMBOL_BACKGROUND ' '
+
+/**
+ * @brief The number of bits of the hash of the LZ codec's match finder.
+ */
+#define LZ_HASH_BITS 12
+
+/**
+ * @brief The number of entries in the hash table of the LZ codec's match finder.
+ */
+#define LZ_HASH_SIZE (1u << LZ_HASH_BITS)
+
+/**
+ * @brief The shortest match the LZ codec encodes.
+ */
+#define LZ_MATCH_MIN 4
+
+/**
+ * @brief The signature at the start of every snapshot file.
+ */
+#define SNAPSHOT_MAGIC "3DSNAP02"
+
+/**
+ * @brief The minimum time the tuner spends measuring every kernel and axis.
+ */
+#define TUNE_SECONDS 0.02
+
+/**
+ * @brief The longest line of the tuning cache, including its newline.
+ */
+#define TUNE_LINE_MAX 256
+
+/**
+ * @brief The number of seconds between two writes of the metrics file.
+ */
+#define METRICS_INTERVAL_SECONDS 1
+
+/**
+ * @brief The number of finite buckets of the latency histograms.
+ */
+#define METRICS_BUCKET_COUNT 6
+
+/**
+ * @brief The most operations in a sequence of the verification mode.
+ */
+#define VERIFY_SEQUENCE_MAX 24
+
+/**
+ * @brief The number of dimensions a soak benchmark cycles through.
+ */
+#define SOAK_DIMENSIONS 3
+
+/**
+ * @brief The number of operations a soak benchmark runs between samples.
+ */
+#define SOAK_WINDOW 65536
+
+/**
+ * @brief The factor by which the median latency of a soak window may exceed
+ *        the best median of its dimension before it counts as creep.
+ */
+#define SOAK_CREEP_RATIO 1.5
+
+/**
+ * @brief The bytes of resident memory growth, and of free heap, a soak
+ *        benchmark tolerates.
+ */
+#define SOAK_SLACK_BYTES (4u << 20)
+
+/**
+ * @brief The number of tensors each queue of the batch pipeline holds.
+ */
+#define BATCH_QUEUE_CAPACITY 4
+
+/**
+ * @brief The maximum number of threads of every stage of the batch pipeline.
+ */
+#define BATCH_THREADS_MAX 16
+
+/**
+ * @brief The signature at the start of the initial sync of a standby.
+ */
+#define REPLICA_MAGIC "3DREPL01"
+
+/**
+ * @brief The initial value of the 64-bit FNV-1a hash.
+ */
+#define HASH_SEED 0xcbf29ce484222325u
+
+/**
+ * @brief The reversed Castagnoli polynomial of CRC32C.
+ */
+#define CRC32C_POLYNOMIAL 0x82f63b78u
+
+/**
+ * @brief A compressed section held by the section store, shared by every
+ *        cold section with the same contents.
+ */
+typedef struct section_block {
+	struct section_block* next;
+	uint64_t hash;
+	uint32_t references;
+	uint32_t size;
+	uint8_t data[];
+} section_block_t;
+
+/**
+ * @brief The content-addressed store of compressed sections, shared by the
+ *        cold stores of every tensor in the process.
+ *
+ * Blocks are hash-consed: a compressed section identical to a stored block
+ * adds a reference to that block instead of a copy, so memory scales with
+ * the unique contents. Blocks are immutable; thawing a section copies it out
+ * of its block, which drops a reference and is freed with the last one.
+ * Buckets are chained, and double whenever the blocks outnumber them.
+ */
+typedef struct {
+	section_block_t** buckets;
+	uint32_t bucket_count;
+	uint32_t block_count;
+	uint64_t references;
+	pthread_mutex_t lock;
+} section_store_t;
+
+/**
+ * @brief The section store of the process.
+ */
+static section_store_t section_store = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/**
+ * @brief Compressed storage for the sections of a third-order tensor that
+ *        have not been used recently.
+ *
+ * A section is either hot, with its elements in the tensor's buffer, or cold,
+ * with its elements compressed into one block of the section store per
+ * channel. Blocks are indexed by channel * dimension + section, the position
+ * of the section's plane within the buffer. The pages of the buffer holding
+ * only cold sections are returned to the kernel. Sections are ordered by the
+ * clock value of their last use to find the least recently used hot section.
+ */
+struct cold_store {
+	section_block_t** blocks;
+	uint32_t* last_use;
+	bool* released;
+	uint32_t clock;
+	uint32_t page_size;
+	uint8_t hot_max;
+};
+
+/**
+ * @brief Worker processes owning slabs of consecutive sections of a
+ *        third-order tensor.
+ *
+ * The tensor's buffer is one half of a shared mapping; the other half is the
+ * destination of all-to-all exchanges, after which the halves swap roles.
+ * Worker k owns the sections [k * dimension / workers, (k + 1) * dimension /
+ * workers) of either half and is commanded over its own Unix socket.
+ */
+struct slab_pool {
+	uint8_t* halves[2];
+	int sockets[TENSOR3_WORKERS_MAX];
+	pid_t pids[TENSOR3_WORKERS_MAX];
+	uint8_t workers;
+	uint8_t front;
+};
+
+/**
+ * @brief A command sent to the worker processes of a slab pool.
+ */
+typedef struct {
+	uint8_t axis;
+	uint8_t front;
+} slab_command_t;
+
+/**
+ * @brief Enumeration of the categories memory is allocated for.
+ *
+ * Tensor memory holds elements, including the back buffers of operations
+ * rewriting the whole tensor. Scratch memory holds the working buffers of
+ * diagnostic modes. The other categories belong to the optional subsystems:
+ * the cold store, snapshots, slab workers, and metrics.
+ */
+typedef enum {
+	MEMORY_TENSOR,
+	MEMORY_COLD,
+	MEMORY_SNAPSHOT,
+	MEMORY_SLABS,
+	MEMORY_METRICS,
+	MEMORY_SCRATCH,
+	MEMORY_COUNT,
+} memory_category_t;
+
+/**
+ * @brief The names of the memory categories, as reported.
+ */
+static const char* const MEMORY_NAMES[MEMORY_COUNT] = {
+	[MEMORY_TENSOR] = "tensor",
+	[MEMORY_COLD] = "cold_store",
+	[MEMORY_SNAPSHOT] = "snapshot",
+	[MEMORY_SLABS] = "slabs",
+	[MEMORY_METRICS] = "metrics",
+	[MEMORY_SCRATCH] = "scratch",
+};
+
+/**
+ * @brief The bytes currently allocated for a memory category, and the most
+ *        ever allocated at once.
+ */
+typedef struct {
+	atomic_uint_fast64_t current;
+	atomic_uint_fast64_t peak;
+} memory_usage_t;
+
+/**
+ * @brief The memory allocated for every category by the whole process.
+ *
+ * Allocations are charged with their usable size, so that they can be freed
+ * without their size being passed around.
+ */
+static memory_usage_t memory_usage[MEMORY_COUNT];
+
+/**
+ * @brief The names of the operations, as labelled in the metrics file.
+ */
+static const char* const OPERATION_NAMES[OPERATION_COUNT] = {
+	[OPERATION_ROTATE] = "rotate",
+	[OPERATION_ROTATE_ANGLE] = "rotate_angle",
+	[OPERATION_ROTATE_BOX] = "rotate_box",
+	[OPERATION_SYMMETRY] = "symmetry",
+	[OPERATION_RENDER] = "render",
+	[OPERATION_RESIZE] = "resize",
+	[OPERATION_CHECKSUM] = "checksum",
+};
+
+/**
+ * @brief The upper bounds in seconds of the finite latency buckets.
+ */
+static const double METRICS_BUCKETS[METRICS_BUCKET_COUNT] = { 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1 };
+
+/**
+ * @brief Counters of a third-order tensor's operations, written periodically
+ *        to a file in the Prometheus text format by a background thread.
+ *
+ * The operations only add to the atomic counters; the writer formats them,
+ * writes the file next to its destination and renames it into place. The
+ * buckets are not cumulative: the last one counts the operations slower than
+ * every bound.
+ */
+struct metrics {
+	const char* path;
+	atomic_uint_fast64_t buckets[OPERATION_COUNT][METRICS_BUCKET_COUNT + 1];
+	atomic_uint_fast64_t nanoseconds[OPERATION_COUNT];
+	atomic_uint_fast64_t bytes_moved;
+	atomic_uint_fast32_t dimension;
+	atomic_uint_fast32_t channels;
+	pthread_t writer;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	bool stop;
+};
+
+/**
+ * @brief The names of the kernels, as given on the command line.
+ */
+static const char* const KERNEL_NAMES[KERNEL_COUNT] = {
+	[KERNEL_QUARTET] = "quartet",
+	[KERNEL_HYPERCUBE] = "hypercube",
+	[KERNEL_PERMUTE] = "permute",
+};
+
+/**
+ * @brief A tensor of any rank up to HYPERCUBE_RANK_MAX, described by the
+ *        extent and the stride of every axis of a one-dimensional buffer.
+ *
+ * Only axes of equal extent can form a plane of rotation. A third-order tensor
+ * with uniform dimensions is a hypercube of rank 3 with strides 1, width, and
+ * width * height.
+ */
+typedef struct {
+	uint8_t* buffer;
+	uint8_t rank;
+	uint32_t extents[HYPERCUBE_RANK_MAX];
+	size_t strides[HYPERCUBE_RANK_MAX];
+} hypercube_t;
+
+/**
+ * @brief Four coordinates within a third-order tensor whose elements must be
+ *        rotated 90 degress.
+ *
+ * Rotating the elements of a matrix (or, rather, a cross section of a
+ * third-order tensor) 90 degrees cannot be done completely in-place, as
+ * elements will be overwritten. To do in-place rotation, and even just to
+ * calculate the corresponding index in which an element will be rotated to,
+ * we can group elements of the cross section into quartets: groups of four
+ * that can be rotated in tandem. Instead of creating a copy of the entire
+ * cross section, only the quartet of elements need to be copied to prevent
+ * overwritting the data which is also rotated. Element one takes the position
+ * of element two, element two takes the position of element three, element
+ * three takes the position of element four, and element four takes the
+ * position of element one. This structure tracks the coordinates of the four
+ * cooresponding elements.
+ */
+typedef struct {
+	coordinate_t first, second, third, fourth;
+} quartet_t;
+
+/**
+ * @brief The plane of rotation of every axis, as a pair of coordinate indices
+ *        (0 for x, 1 for y, 2 for z).
+ *
+ * Rotating about an axis moves the element at coordinates (a, b) of its plane
+ * to (dimension - 1 - b, a); the order of the pair gives the direction.
+ */
+static const uint8_t AXIS_PLANES[][2] = {
+	[AXIS_XPOSITIVE] = { 1, 2 },
+	[AXIS_XNEGATIVE] = { 2, 1 },
+	[AXIS_YPOSITIVE] = { 2, 0 },
+	[AXIS_YNEGATIVE] = { 0, 2 },
+	[AXIS_ZPOSITIVE] = { 0, 1 },
+	[AXIS_ZNEGATIVE] = { 1, 0 },
+};
+
+/**
+ * @brief State shared by the workers resampling a rotated third-order tensor.
+ *
+ * The matrix maps the offset of a destination element from the center of the
+ * tensor to the offset of the source position it is sampled from.
+ */
+typedef struct {
+	const tensor3_t* tensor3;
+	uint8_t* destination;
+	float matrix[3][3];
+} resample_t;
+
+/**
+ * @brief Enumeration of the operations of the verification mode.
+ */
+typedef enum {
+	VERIFY_ROTATE,
+	VERIFY_ROTATE_BOX,
+	VERIFY_SHIFT,
+	VERIFY_NORMALIZE,
+	VERIFY_MIRROR,
+	VERIFY_SYMMETRY,
+	VERIFY_ROTATE_ANGLE,
+	VERIFY_RESIZE,
+	VERIFY_SNAPSHOT,
+	VERIFY_KIND_COUNT,
+} verify_kind_t;
+
+/**
+ * @brief An operation of a verification sequence, with the parameters of
+ *        every kind of operation drawn in advance.
+ */
+typedef struct {
+	verify_kind_t kind;
+	axis_t axis;
+	region_t region;
+	uint8_t shift_axis;
+	int distance;
+	symmetry_t symmetry;
+	uint8_t turns;
+	uint8_t resize;
+} verify_operation_t;
+
+/**
+ * @brief A way of executing operations that the verification mode compares
+ *        with the quartet kernel.
+ *
+ * Besides the kernel, a variant may queue its rotations as symmetries, use a
+ * random kernel for every axis, compress cold sections, or split the tensor
+ * into slabs. The reference applies symmetries element by element and
+ * resampled quarter turns as 90 degree rotations, independently of the
+ * kernels the other variants use for them.
+ */
+typedef struct {
+	const char* name;
+	bool reference;
+	kernel_t kernel;
+	bool queued;
+	bool mixed;
+	bool cold;
+	bool slabs;
+} verify_variant_t;
+
+/**
+ * @brief The variants verified against the quartet kernel.
+ */
+static const verify_variant_t VERIFY_VARIANTS[] = {
+	{ .name = "hypercube", .kernel = KERNEL_HYPERCUBE },
+	{ .name = "permute", .kernel = KERNEL_PERMUTE },
+	{ .name = "queued", .queued = true },
+	{ .name = "mixed plan", .mixed = true },
+	{ .name = "cold store", .cold = true },
+	{ .name = "cold hypercube", .kernel = KERNEL_HYPERCUBE, .cold = true },
+	{ .name = "slabs", .slabs = true },
+};
+
+/**
+ * @brief A tensor file passing through the batch pipeline.
+ */
+typedef struct {
+	char input[PATH_MAX];
+	char output[PATH_MAX];
+	tensor3_t tensor3;
+} batch_job_t;
+
+/**
+ * @brief A bounded queue of jobs between two stages of the batch pipeline.
+ *
+ * Pushing blocks while the queue is full and popping while it is empty. Once
+ * every producer has closed the queue, popping an empty queue returns NULL.
+ */
+typedef struct {
+	batch_job_t* jobs[BATCH_QUEUE_CAPACITY];
+	uint8_t head;
+	uint8_t count;
+	uint8_t producers;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+} batch_queue_t;
+
+/**
+ * @brief The state shared by the threads of the batch pipeline.
+ *
+ * Loaders read lines of the manifest and load the input files into tensors,
+ * rotators apply the program to them, and storers write the output files.
+ */
+typedef struct {
+	const tensor3_config_t* config;
+	symmetry_t program;
+	FILE* manifest;
+	batch_queue_t loaded;
+	batch_queue_t rotated;
+	atomic_uint_fast32_t done;
+	atomic_uint_fast32_t failed;
+} batch_t;
+
+/**
+ * @brief The header of the initial sync of a standby, followed by the
+ *        buffer of the primary's tensor with its origin normalized.
+ */
+typedef struct {
+	char magic[8];
+	uint8_t dimension;
+	uint8_t channels;
+	uint8_t intensity_channels;
+	uint8_t kernel;
+	uint8_t plan[AXIS_ZNEGATIVE + 1];
+	uint8_t section;
+	uint8_t channel;
+} replica_header_t;
+
+/**
+ * @brief A function processing the range [begin, end) of a parallel loop.
+ * @param[in,out] context Caller-provided state shared by all workers.
+ * @param[in] begin The first iteration of the range.
+ * @param[in] end One past the last iteration of the range.
+ * @return true if the range was processed successfully, false otherwise
+ */
+typedef bool (*parallel_fn_t)(void* context, uint32_t begin, uint32_t end);
+
+/**
+ * @brief A contiguous range of a parallel loop assigned to one worker thread.
+ */
+typedef struct {
+	parallel_fn_t fn;
+	void* context;
+	uint32_t begin, end;
+	bool result;
+} parallel_task_t;
+
+/**
+ * @brief A range of sections whose checksums are recomputed in parallel.
+ *
+ * Iteration i covers section (first + i % count) % dimension of channel
+ * i / count, so the range may wrap around the last section.
+ */
+typedef struct {
+	tensor3_t* tensor3;
+	uint8_t first;
+	uint8_t count;
+} checksum_range_t;
+
+/**
+ * @brief State shared by the workers importing a raw volume file.
+ */
+typedef struct {
+	tensor3_t* tensor3;
+	int fd;
+} tensor3_import_t;
+
+/**
+ * @brief The header at the start of a snapshot file.
+ */
+typedef struct {
+	char magic[8];
+	uint32_t dimension;
+	uint32_t block_count;
+} snapshot_header_t;
+
+/**
+ * @brief An entry of a snapshot's block index, locating the compressed block
+ *        of one section within the snapshot file.
+ *
+ * The checksum is the CRC32C of the decompressed section.
+ */
+typedef struct {
+	uint64_t offset;
+	uint32_t size;
+	uint32_t raw_size;
+	uint32_t checksum;
+	uint32_t reserved;
+} snapshot_block_t;
+
+/**
+ * @brief State of a snapshot being saved or loaded.
+ *
+ * When saving, blocks holds one lz_bound sized slot per section. When loading,
+ * blocks holds the file contents, so block offsets index it directly.
+ */
+typedef struct {
+	tensor3_t* tensor3;
+	snapshot_header_t header;
+	snapshot_block_t* index;
+	uint8_t* blocks;
+	uint64_t file_size;
+} snapshot_t;
+
+/**
+ * @brief Parse the name of a rotation kernel.
+ * @param[in] arg The name of the kernel.
+ * @param[out] kernel The parsed kernel.
+ * @return true if the name matched a kernel, false otherwise
+ */
+bool kernel_parse(const char* const arg, kernel_t* const kernel) {
+	for (uint8_t k = 0; k < KERNEL_COUNT; k++) {
+		if (!strcmp(arg, KERNEL_NAMES[k])) {
+			*kernel = (kernel_t)k;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Calculate the seconds elapsed since a point in time.
+ * @param[in] start The starting point, taken from the monotonic clock.
+ * @return The elapsed time in seconds.
+ */
+static double clock_elapsed(const struct timespec* const start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Write a buffer to a file, retrying short writes.
+ * @param[in] fd The file descriptor to write to.
+ * @param[in] data The data to write.
+ * @param[in] size The number of bytes to write.
+ * @return true if everything was written, false otherwise
+ */
+static bool fd_write_all(const int fd, const void* const data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	while (size) {
+		ssize_t written = write(fd, bytes, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return false;
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+/**
+ * @brief Read a range of a file, retrying short reads.
+ * @param[in] fd The file descriptor to read from.
+ * @param[out] data The buffer to read into.
+ * @param[in] size The number of bytes to read.
+ * @param[in] offset The position in the file to read from.
+ * @return true if everything was read, false otherwise
+ */
+static bool fd_read_all(const int fd, void* const data, size_t size, off_t offset) {
+	uint8_t* bytes = (uint8_t*)data;
+	while (size) {
+		ssize_t bytes_read = pread(fd, bytes, size, offset);
+		if (bytes_read < 0 && errno == EINTR)
+			continue;
+		if (bytes_read <= 0)
+			return false;
+		bytes += bytes_read;
+		size -= bytes_read;
+		offset += bytes_read;
+	}
+	return true;
+}
+
+/**
+ * @brief Add to the bytes allocated for a category, raising its peak.
+ * @param[in] category The category of the allocation.
+ * @param[in] delta The number of bytes allocated, or freed if negative.
+ */
+static void memory_account(const memory_category_t category, const int64_t delta) {
+	memory_usage_t* const usage = &memory_usage[category];
+	const uint64_t current = atomic_fetch_add_explicit(&usage->current, (uint64_t)delta, memory_order_relaxed) + (uint64_t)delta;
+	uint64_t peak = atomic_load_explicit(&usage->peak, memory_order_relaxed);
+	while (current > peak
+		&& !atomic_compare_exchange_weak_explicit(&usage->peak, &peak, current, memory_order_relaxed, memory_order_relaxed));
+}
+
+/**
+ * @brief Allocate memory on behalf of a category.
+ * @param[in] category The category to charge.
+ * @param[in] size The number of bytes to allocate.
+ * @return The allocation, or NULL if it failed.
+ */
+static void* memory_alloc(const memory_category_t category, const size_t size) {
+	void* const pointer = malloc(size);
+	if (pointer)
+		memory_account(category, malloc_usable_size(pointer));
+	return pointer;
+}
+
+/**
+ * @brief Allocate zeroed memory on behalf of a category.
+ * @param[in] category The category to charge.
+ * @param[in] count The number of elements to allocate.
+ * @param[in] size The size of every element.
+ * @return The allocation, or NULL if it failed.
+ */
+static void* memory_calloc(const memory_category_t category, const size_t count, const size_t size) {
+	void* const pointer = calloc(count, size);
+	if (pointer)
+		memory_account(category, malloc_usable_size(pointer));
+	return pointer;
+}
+
+/**
+ * @brief Resize an allocation of a category.
+ * @param[in] category The category charged for the allocation.
+ * @param[in] pointer The allocation to resize.
+ * @param[in] size The new size in bytes.
+ * @return The resized allocation, or NULL if it failed and the original
+ *         allocation is left untouched.
+ */
+static void* memory_realloc(const memory_category_t category, void* const pointer, const size_t size) {
+	const size_t previous = malloc_usable_size(pointer);
+	void* const resized = realloc(pointer, size);
+	if (resized)
+		memory_account(category, (int64_t)malloc_usable_size(resized) - (int64_t)previous);
+	return resized;
+}
+
+/**
+ * @brief Free an allocation of a category.
+ * @param[in] category The category charged for the allocation.
+ * @param[in] pointer The allocation to free, or NULL.
+ */
+static void memory_free(const memory_category_t category, void* const pointer) {
+	if (!pointer)
+		return;
+	memory_account(category, -(int64_t)malloc_usable_size(pointer));
+	free(pointer);
+}
+
+/**
+ * @brief Map anonymous memory on behalf of a category.
+ * @param[in] category The category to charge.
+ * @param[in] size The number of bytes to map.
+ * @param[in] flags MAP_PRIVATE or MAP_SHARED.
+ * @return The mapping, or NULL if it failed.
+ */
+static void* memory_map(const memory_category_t category, const size_t size, const int flags) {
+	void* const mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, flags | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED)
+		return NULL;
+	memory_account(category, size);
+	return mapping;
+}
+
+/**
+ * @brief Unmap memory mapped with memory_map.
+ * @param[in] category The category charged for the mapping.
+ * @param[in] mapping The mapping to unmap.
+ * @param[in] size The size the mapping was created with.
+ */
+static void memory_unmap(const memory_category_t category, void* const mapping, const size_t size) {
+	if (!munmap(mapping, size))
+		memory_account(category, -(int64_t)size);
+}
+
+/**
+ * @brief Read the resident set size of the process.
+ * @return The resident memory in bytes, or 0 if it cannot be read.
+ */
+static uint64_t process_resident_bytes() {
+	FILE* const statm = fopen("/proc/self/statm", "r");
+	unsigned long long pages = 0;
+	if (statm) {
+		if (fscanf(statm, "%*u %llu", &pages) != 1)
+			pages = 0;
+		fclose(statm);
+	}
+	return pages * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * @brief Print the current and peak memory of every category, the resident
+ *        memory, and the page faults of the process.
+ * @param[in] stream The stream to print to.
+ */
+void memory_report(FILE* const stream) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+		memset(&usage, 0, sizeof(usage));
+	fprintf(stream, "%-12s %14s %14s\n", "memory", "current", "peak");
+	for (uint8_t category = 0; category < MEMORY_COUNT; category++)
+		fprintf(stream, "%-12s %14llu %14llu\n",
+			MEMORY_NAMES[category],
+			(unsigned long long)atomic_load_explicit(&memory_usage[category].current, memory_order_relaxed),
+			(unsigned long long)atomic_load_explicit(&memory_usage[category].peak, memory_order_relaxed));
+	fprintf(stream, "%-12s %14llu %14llu\n",
+		"resident",
+		(unsigned long long)process_resident_bytes(),
+		(unsigned long long)usage.ru_maxrss * 1024);
+	fprintf(stream, "page faults: %ld minor, %ld major\n", usage.ru_minflt, usage.ru_majflt);
+	pthread_mutex_lock(&section_store.lock);
+	fprintf(stream, "section store: %u blocks for %llu cold sections\n",
+		section_store.block_count, (unsigned long long)section_store.references);
+	pthread_mutex_unlock(&section_store.lock);
+}
+
+/**
+ * @brief Allocate an element buffer.
+ * @param[in] size The number of bytes to allocate.
+ * @return The page-aligned buffer, or NULL if the allocation failed.
+ *
+ * The buffer is page-aligned and padded to whole pages so that pages holding
+ * only cold sections can be released. It is charged to tensor memory and
+ * freed with memory_free.
+ */
+static uint8_t* buffer_alloc(const size_t size) {
+	const size_t page_size = sysconf(_SC_PAGESIZE);
+	uint8_t* const buffer = (uint8_t*)aligned_alloc(page_size, (size + page_size - 1) / page_size * page_size);
+	if (buffer)
+		memory_account(MEMORY_TENSOR, malloc_usable_size(buffer));
+	return buffer;
+}
+
+/**
+ * @brief Resize an element buffer allocated by buffer_alloc.
+ * @param[in] buffer The buffer to resize.
+ * @param[in] size The number of bytes the buffer must hold.
+ * @return The buffer holding the leading bytes of the old one, or NULL if the
+ *         allocation failed and the old buffer is unchanged.
+ *
+ * realloc moves buffers served by mmap with mremap instead of copying them.
+ * Should it return a buffer that is not page-aligned, the buffer is copied
+ * once more into an aligned one if possible.
+ */
+static uint8_t* buffer_realloc(uint8_t* const buffer, const size_t size) {
+	const size_t page_size = sysconf(_SC_PAGESIZE);
+	const size_t padded = (size + page_size - 1) / page_size * page_size;
+	uint8_t* const resized = (uint8_t*)memory_realloc(MEMORY_TENSOR, buffer, padded);
+	if (!resized || !((uintptr_t)resized % page_size))
+		return resized;
+	uint8_t* const aligned = buffer_alloc(padded);
+	if (!aligned)
+		return resized;
+	memcpy(aligned, resized, padded);
+	memory_free(MEMORY_TENSOR, resized);
+	return aligned;
+}
+
+/**
+ * @brief Determine the number of worker threads to use for parallel loops.
+ * @return The number of online processors, clamped to [1, PARALLEL_THREADS_MAX].
+ */
+static uint8_t parallel_thread_count() {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count < 1)
+		return 1;
+	return count > PARALLEL_THREADS_MAX ? PARALLEL_THREADS_MAX : (uint8_t)count;
+}
+
+/**
+ * @brief Entry point of a worker thread of a parallel loop.
+ * @param[in,out] arg The parallel_task_t assigned to the worker.
+ * @return NULL
+ */
+static void* parallel_worker(void* arg) {
+	parallel_task_t* task = (parallel_task_t*)arg;
+	task->result = task->fn(task->context, task->begin, task->end);
+	return NULL;
+}
+
+/**
+ * @brief Split the iterations [0, count) into contiguous ranges and process
+ *        them on multiple threads.
+ * @param[in] count The number of iterations.
+ * @param[in] fn The function processing a range of iterations.
+ * @param[in,out] context Caller-provided state passed to every range.
+ * @return true if all ranges were processed successfully, false otherwise
+ *
+ * The calling thread processes the first range itself. If a worker thread
+ * cannot be created, its range is processed by the calling thread instead.
+ */
+static bool parallel_for(const uint32_t count, const parallel_fn_t fn, void* const context) {
+	uint8_t threads = parallel_thread_count();
+	if (threads > count)
+		threads = count ? (uint8_t)count : 1;
+	parallel_task_t tasks[PARALLEL_THREADS_MAX];
+	pthread_t workers[PARALLEL_THREADS_MAX];
+	bool spawned[PARALLEL_THREADS_MAX] = { false };
+	for (uint8_t t = 0; t < threads; t++)
+		tasks[t] = (parallel_task_t){
+			.fn = fn,
+			.context = context,
+			.begin = (uint32_t)((uint64_t)count * t / threads),
+			.end = (uint32_t)((uint64_t)count * (t + 1) / threads),
+			.result = false
+		};
+	for (uint8_t t = 1; t < threads; t++)
+		spawned[t] = !pthread_create(&workers[t], NULL, parallel_worker, &tasks[t]);
+	bool result = true;
+	for (uint8_t t = 0; t < threads; t++) {
+		if (spawned[t])
+			pthread_join(workers[t], NULL);
+		else
+			parallel_worker(&tasks[t]);
+		result = result && tasks[t].result;
+	}
+	return result;
+}
+
+/**
+ * @brief Record an operation in the metrics.
+ * @param[in,out] metrics The metrics to add to, or NULL if none are kept.
+ * @param[in] operation The operation performed.
+ * @param[in] start When the operation started, on the monotonic clock.
+ * @param[in] bytes The number of bytes the operation moved.
+ */
+void metrics_observe(
+	metrics_t* const metrics,
+	const operation_t operation,
+	const struct timespec* const start,
+	const uint64_t bytes
+) {
+	if (!metrics)
+		return;
+	const double seconds = clock_elapsed(start);
+	uint8_t bucket = 0;
+	while (bucket < METRICS_BUCKET_COUNT && seconds > METRICS_BUCKETS[bucket])
+		bucket++;
+	atomic_fetch_add_explicit(&metrics->buckets[operation][bucket], 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&metrics->nanoseconds[operation], (uint64_t)(seconds * 1e9), memory_order_relaxed);
+	atomic_fetch_add_explicit(&metrics->bytes_moved, bytes, memory_order_relaxed);
+}
+
+/**
+ * @brief Write the metrics to their file in the Prometheus text format.
+ * @param[in] metrics The metrics to write.
+ * @return true if the file was replaced, false otherwise
+ *
+ * The metrics are written to a temporary file beside the destination, which
+ * is then renamed over it, so readers never see a partial file.
+ */
+static bool metrics_write(metrics_t* const metrics) {
+	char temporary[PATH_MAX];
+	if (snprintf(temporary, sizeof(temporary), "%s.tmp", metrics->path) >= (int)sizeof(temporary))
+		return false;
+	FILE* const file = fopen(temporary, "w");
+	if (!file)
+		return false;
+	uint64_t counts[OPERATION_COUNT][METRICS_BUCKET_COUNT + 1];
+	for (uint8_t operation = 0; operation < OPERATION_COUNT; operation++)
+		for (uint8_t bucket = 0; bucket <= METRICS_BUCKET_COUNT; bucket++)
+			counts[operation][bucket] = atomic_load_explicit(&metrics->buckets[operation][bucket], memory_order_relaxed);
+	fprintf(file, "# HELP tensor3_operations_total Operations performed on the tensor.\n");
+	fprintf(file, "# TYPE tensor3_operations_total counter\n");
+	for (uint8_t operation = 0; operation < OPERATION_COUNT; operation++) {
+		uint64_t total = 0;
+		for (uint8_t bucket = 0; bucket <= METRICS_BUCKET_COUNT; bucket++)
+			total += counts[operation][bucket];
+		fprintf(file, "tensor3_operations_total{operation=\"%s\"} %llu\n", OPERATION_NAMES[operation], (unsigned long long)total);
+	}
+	fprintf(file, "# HELP tensor3_operation_seconds Latency of the operations performed on the tensor.\n");
+	fprintf(file, "# TYPE tensor3_operation_seconds histogram\n");
+	for (uint8_t operation = 0; operation < OPERATION_COUNT; operation++) {
+		const char* const name = OPERATION_NAMES[operation];
+		uint64_t cumulative = 0;
+		for (uint8_t bucket = 0; bucket < METRICS_BUCKET_COUNT; bucket++) {
+			cumulative += counts[operation][bucket];
+			fprintf(file, "tensor3_operation_seconds_bucket{operation=\"%s\",le=\"%g\"} %llu\n", name, METRICS_BUCKETS[bucket], (unsigned long long)cumulative);
+		}
+		cumulative += counts[operation][METRICS_BUCKET_COUNT];
+		fprintf(file, "tensor3_operation_seconds_bucket{operation=\"%s\",le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative);
+		fprintf(file, "tensor3_operation_seconds_sum{operation=\"%s\"} %.9f\n", name, atomic_load_explicit(&metrics->nanoseconds[operation], memory_order_relaxed) / 1e9);
+		fprintf(file, "tensor3_operation_seconds_count{operation=\"%s\"} %llu\n", name, (unsigned long long)cumulative);
+	}
+	fprintf(file, "# HELP tensor3_bytes_moved_total Bytes of elements moved by the operations.\n");
+	fprintf(file, "# TYPE tensor3_bytes_moved_total counter\n");
+	fprintf(file, "tensor3_bytes_moved_total %llu\n", (unsigned long long)atomic_load_explicit(&metrics->bytes_moved, memory_order_relaxed));
+	fprintf(file, "# HELP tensor3_dimension The dimension of the tensor.\n");
+	fprintf(file, "# TYPE tensor3_dimension gauge\n");
+	fprintf(file, "tensor3_dimension %u\n", (unsigned)atomic_load_explicit(&metrics->dimension, memory_order_relaxed));
+	fprintf(file, "# HELP tensor3_channels The number of channels of every element.\n");
+	fprintf(file, "# TYPE tensor3_channels gauge\n");
+	fprintf(file, "tensor3_channels %u\n", (unsigned)atomic_load_explicit(&metrics->channels, memory_order_relaxed));
+	fprintf(file, "# HELP process_resident_memory_bytes Resident memory size in bytes.\n");
+	fprintf(file, "# TYPE process_resident_memory_bytes gauge\n");
+	fprintf(file, "process_resident_memory_bytes %llu\n", (unsigned long long)process_resident_bytes());
+	fprintf(file, "# HELP tensor3_memory_bytes Bytes allocated for every memory category.\n");
+	fprintf(file, "# TYPE tensor3_memory_bytes gauge\n");
+	for (uint8_t category = 0; category < MEMORY_COUNT; category++)
+		fprintf(file, "tensor3_memory_bytes{category=\"%s\"} %llu\n", MEMORY_NAMES[category], (unsigned long long)atomic_load_explicit(&memory_usage[category].current, memory_order_relaxed));
+	fprintf(file, "# HELP tensor3_memory_peak_bytes Most bytes ever allocated at once for every memory category.\n");
+	fprintf(file, "# TYPE tensor3_memory_peak_bytes gauge\n");
+	for (uint8_t category = 0; category < MEMORY_COUNT; category++)
+		fprintf(file, "tensor3_memory_peak_bytes{category=\"%s\"} %llu\n", MEMORY_NAMES[category], (unsigned long long)atomic_load_explicit(&memory_usage[category].peak, memory_order_relaxed));
+	struct rusage usage;
+	if (!getrusage(RUSAGE_SELF, &usage)) {
+		fprintf(file, "# HELP process_page_faults_total Page faults of the process.\n");
+		fprintf(file, "# TYPE process_page_faults_total counter\n");
+		fprintf(file, "process_page_faults_total{type=\"minor\"} %ld\n", usage.ru_minflt);
+		fprintf(file, "process_page_faults_total{type=\"major\"} %ld\n", usage.ru_majflt);
+	}
+	const bool written = !ferror(file);
+	if (fclose(file) || !written || rename(temporary, metrics->path)) {
+		unlink(temporary);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Write the metrics file every METRICS_INTERVAL_SECONDS until stopped.
+ * @param[in,out] context The metrics_t to write.
+ * @return NULL
+ *
+ * The file is written once more when the writer is stopped.
+ */
+static void* metrics_writer(void* const context) {
+	metrics_t* const metrics = (metrics_t*)context;
+	pthread_mutex_lock(&metrics->lock);
+	while (!metrics->stop) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += METRICS_INTERVAL_SECONDS;
+		pthread_cond_timedwait(&metrics->wake, &metrics->lock, &deadline);
+		pthread_mutex_unlock(&metrics->lock);
+		metrics_write(metrics);
+		pthread_mutex_lock(&metrics->lock);
+	}
+	pthread_mutex_unlock(&metrics->lock);
+	return NULL;
+}
+
+/**
+ * @brief Start writing the metrics of a third-order tensor to a file.
+ * @param[in] path The path of the metrics file.
+ * @param[in] dimension The dimension of the tensor.
+ * @param[in] channels The number of channels of the tensor.
+ * @return The metrics, or NULL if the writer could not be started.
+ */
+static metrics_t* metrics_start(const char* const path, const uint8_t dimension, const uint8_t channels) {
+	metrics_t* const metrics = (metrics_t*)memory_calloc(MEMORY_METRICS, 1, sizeof(metrics_t));
+	if (!metrics)
+		return NULL;
+	metrics->path = path;
+	atomic_store(&metrics->dimension, dimension);
+	atomic_store(&metrics->channels, channels);
+	pthread_mutex_init(&metrics->lock, NULL);
+	pthread_cond_init(&metrics->wake, NULL);
+	if (pthread_create(&metrics->writer, NULL, metrics_writer, metrics)) {
+		pthread_cond_destroy(&metrics->wake);
+		pthread_mutex_destroy(&metrics->lock);
+		memory_free(MEMORY_METRICS, metrics);
+		return NULL;
+	}
+	return metrics;
+}
+
+/**
+ * @brief Stop the metrics writer after a final write, and free the metrics.
+ * @param[in,out] metrics The metrics to stop, or NULL if none are kept.
+ */
+static void metrics_stop(metrics_t* const metrics) {
+	if (!metrics)
+		return;
+	pthread_mutex_lock(&metrics->lock);
+	metrics->stop = true;
+	pthread_cond_signal(&metrics->wake);
+	pthread_mutex_unlock(&metrics->lock);
+	pthread_join(metrics->writer, NULL);
+	pthread_cond_destroy(&metrics->wake);
+	pthread_mutex_destroy(&metrics->lock);
+	memory_free(MEMORY_METRICS, metrics);
+}
+
+/**
+ * @brief Calculate the worst-case compressed size of a block.
+ * @param[in] size The uncompressed size of the block.
+ * @return The largest size lz_compress can produce for the block.
+ */
+static uint32_t lz_bound(const uint32_t size) {
+	return size + size / 255 + 16;
+}
+
+/**
+ * @brief Append a length extension to a compressed stream.
+ * @param[in,out] out The position in the compressed stream to write to.
+ * @param[in] length The remainder of a length that did not fit in its nibble.
+ * @return The position in the compressed stream after the extension.
+ */
+static uint8_t* lz_write_length(uint8_t* out, uint32_t length) {
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = (uint8_t)length;
+	return out;
+}
+
+/**
+ * @brief Read a length extension from a compressed stream.
+ * @param[in,out] in The position in the compressed stream to read from.
+ * @param[in] end The end of the compressed stream.
+ * @param[in,out] length The length to extend.
+ * @return true if the extension was read, false if the stream is truncated
+ */
+static bool lz_read_length(const uint8_t** const in, const uint8_t* const end, uint32_t* const length) {
+	uint8_t byte;
+	do {
+		if (*in >= end)
+			return false;
+		byte = *(*in)++;
+		*length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+/**
+ * @brief Compress a block with a byte-oriented LZ77 codec.
+ * @param[in] src The block to compress.
+ * @param[in] size The size of the block.
+ * @param[out] dst The compressed stream, with room for lz_bound(size) bytes.
+ * @return The size of the compressed stream.
+ *
+ * The stream is a series of sequences. Each sequence starts with a token whose
+ * high nibble holds the number of literals and whose low nibble holds the
+ * match length minus LZ_MATCH_MIN; a nibble of 15 is extended by bytes of 255
+ * terminated by a smaller byte. The literals follow the token, then the
+ * two-byte little-endian distance of the match. The final sequence consists
+ * only of literals. Matches are found through a hash table of the most recent
+ * position of every four-byte prefix.
+ */
+static uint32_t lz_compress(const uint8_t* const src, const uint32_t size, uint8_t* const dst) {
+	uint32_t table[LZ_HASH_SIZE];
+	memset(table, 0xff, sizeof(table));
+	uint8_t* out = dst;
+	uint32_t anchor = 0, i = 0;
+	while (i + LZ_MATCH_MIN <= size) {
+		uint32_t prefix;
+		memcpy(&prefix, src + i, sizeof(prefix));
+		const uint32_t hash = (prefix * 2654435761u) >> (32 - LZ_HASH_BITS);
+		const uint32_t candidate = table[hash];
+		table[hash] = i;
+		if (candidate == UINT32_MAX || i - candidate > UINT16_MAX
+			|| memcmp(src + candidate, src + i, LZ_MATCH_MIN)) {
+			i++;
+			continue;
+		}
+		uint32_t match = LZ_MATCH_MIN;
+		while (i + match < size && src[candidate + match] == src[i + match])
+			match++;
+		const uint32_t literals = i - anchor;
+		uint8_t* token = out++;
+		*token = (uint8_t)((literals < 15 ? literals : 15) << 4);
+		if (literals >= 15)
+			out = lz_write_length(out, literals - 15);
+		memcpy(out, src + anchor, literals);
+		out += literals;
+		const uint16_t distance = (uint16_t)(i - candidate);
+		*out++ = (uint8_t)distance;
+		*out++ = (uint8_t)(distance >> 8);
+		const uint32_t extra = match - LZ_MATCH_MIN;
+		*token |= (uint8_t)(extra < 15 ? extra : 15);
+		if (extra >= 15)
+			out = lz_write_length(out, extra - 15);
+		i += match;
+		anchor = i;
+	}
+	const uint32_t literals = size - anchor;
+	*out++ = (uint8_t)((literals < 15 ? literals : 15) << 4);
+	if (literals >= 15)
+		out = lz_write_length(out, literals - 15);
+	memcpy(out, src + anchor, literals);
+	out += literals;
+	return (uint32_t)(out - dst);
+}
+
+/**
+ * @brief Decompress a block produced by lz_compress.
+ * @param[in] src The compressed stream.
+ * @param[in] src_size The size of the compressed stream.
+ * @param[out] dst The decompressed block.
+ * @param[in] dst_size The expected size of the decompressed block.
+ * @return true if the stream decompressed to exactly dst_size bytes, false otherwise
+ */
+static bool lz_decompress(
+	const uint8_t* const src,
+	const uint32_t src_size,
+	uint8_t* const dst,
+	const uint32_t dst_size
+) {
+	const uint8_t* in = src;
+	const uint8_t* const in_end = src + src_size;
+	uint32_t out = 0;
+	while (in < in_end) {
+		const uint8_t token = *in++;
+		uint32_t literals = token >> 4;
+		if (literals == 15 && !lz_read_length(&in, in_end, &literals))
+			return false;
+		if (literals > (uint32_t)(in_end - in) || literals > dst_size - out)
+			return false;
+		memcpy(dst + out, in, literals);
+		in += literals;
+		out += literals;
+		if (in == in_end)
+			break;
+		if (in_end - in < 2)
+			return false;
+		const uint32_t distance = in[0] | (uint32_t)in[1] << 8;
+		in += 2;
+		uint32_t match = token & 15;
+		if (match == 15 && !lz_read_length(&in, in_end, &match))
+			return false;
+		match += LZ_MATCH_MIN;
+		if (!distance || distance > out || match > dst_size - out)
+			return false;
+		for (uint32_t i = 0; i < match; i++, out++)
+			dst[out] = dst[out - distance];
+	}
+	return out == dst_size;
+}
+
+/**
+ * @brief Hash a block of bytes with 64-bit FNV-1a.
+ * @param[in] hash The hash of the preceding bytes, or HASH_SEED.
+ * @param[in] data The bytes to hash.
+ * @param[in] size The number of bytes.
+ * @return The hash of the preceding bytes followed by these.
+ */
+static uint64_t block_hash(uint64_t hash, const uint8_t* const data, const uint32_t size) {
+	for (uint32_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 0x100000001b3u;
+	return hash;
+}
+
+/**
+ * @brief The table of the bytewise CRC32C, filled by crc32c_select.
+ */
+static uint32_t crc32c_table[256];
+
+/**
+ * @brief Update a CRC32C a byte at a time, through crc32c_table.
+ * @param[in] crc The inverted CRC32C of the preceding bytes.
+ * @param[in] data The bytes to add.
+ * @param[in] size The number of bytes.
+ * @return The inverted CRC32C of the preceding bytes followed by these.
+ */
+static uint32_t crc32c_portable(uint32_t crc, const uint8_t* const data, const size_t size) {
+	for (size_t i = 0; i < size; i++)
+		crc = crc32c_table[(crc ^ data[i]) & 0xff] ^ crc >> 8;
+	return crc;
+}
+
+#if defined(__x86_64__)
+/**
+ * @brief Update a CRC32C eight bytes at a time with the SSE4.2 crc32
+ *        instruction.
+ * @param[in] crc The inverted CRC32C of the preceding bytes.
+ * @param[in] data The bytes to add.
+ * @param[in] size The number of bytes.
+ * @return The inverted CRC32C of the preceding bytes followed by these.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t* const data, const size_t size) {
+	uint64_t wide = crc;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		wide = _mm_crc32_u64(wide, word);
+	}
+	crc = (uint32_t)wide;
+	for (; i < size; i++)
+		crc = _mm_crc32_u8(crc, data[i]);
+	return crc;
+}
+#endif
+
+/**
+ * @brief The CRC32C update of the processor, chosen by crc32c_select.
+ */
+static uint32_t (*crc32c_update)(uint32_t, const uint8_t*, size_t);
+
+/**
+ * @brief Guards the one call of crc32c_select.
+ */
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Fill the bytewise table and pick the SSE4.2 update if the processor
+ *        supports it.
+ */
+static void crc32c_select() {
+	for (uint32_t byte = 0; byte < 256; byte++) {
+		uint32_t crc = byte;
+		for (uint8_t bit = 0; bit < 8; bit++)
+			crc = crc >> 1 ^ (crc & 1 ? CRC32C_POLYNOMIAL : 0);
+		crc32c_table[byte] = crc;
+	}
+	crc32c_update = crc32c_portable;
+#if defined(__x86_64__)
+	if (__builtin_cpu_supports("sse4.2"))
+		crc32c_update = crc32c_sse42;
+#endif
+}
+
+/**
+ * @brief Compute the CRC32C of a block of bytes.
+ * @param[in] data The bytes to checksum.
+ * @param[in] size The number of bytes.
+ * @return The CRC32C of the bytes.
+ */
+static uint32_t crc32c(const uint8_t* const data, const size_t size) {
+	pthread_once(&crc32c_once, crc32c_select);
+	return ~crc32c_update(~0u, data, size);
+}
+
+/**
+ * @brief Double the buckets of the section store, rehashing its blocks.
+ *
+ * The store keeps its current buckets if they cannot be reallocated. Must be
+ * called with the store locked.
+ */
+static void section_store_grow() {
+	const uint32_t bucket_count = section_store.bucket_count ? 2 * section_store.bucket_count : 64;
+	section_block_t** const buckets = (section_block_t**)memory_calloc(MEMORY_COLD, bucket_count, sizeof(section_block_t*));
+	if (!buckets)
+		return;
+	for (uint32_t bucket = 0; bucket < section_store.bucket_count; bucket++) {
+		section_block_t* block = section_store.buckets[bucket];
+		while (block) {
+			section_block_t* const next = block->next;
+			block->next = buckets[block->hash % bucket_count];
+			buckets[block->hash % bucket_count] = block;
+			block = next;
+		}
+	}
+	memory_free(MEMORY_COLD, section_store.buckets);
+	section_store.buckets = buckets;
+	section_store.bucket_count = bucket_count;
+}
+
+/**
+ * @brief Add a reference to the stored block holding a compressed section,
+ *        storing a copy of the section if no block holds it yet.
+ * @param[in] data The compressed section.
+ * @param[in] size The size of the compressed section.
+ * @return The block, or NULL if the block could not be stored.
+ *
+ * The compression is deterministic, so identical sections compress into
+ * identical blocks, and blocks are compared exactly rather than trusting the
+ * hash.
+ */
+static section_block_t* section_intern(const uint8_t* const data, const uint32_t size) {
+	const uint64_t hash = block_hash(HASH_SEED, data, size);
+	pthread_mutex_lock(&section_store.lock);
+	if (section_store.block_count >= section_store.bucket_count)
+		section_store_grow();
+	section_block_t* block = NULL;
+	if (section_store.bucket_count) {
+		block = section_store.buckets[hash % section_store.bucket_count];
+		while (block && (block->hash != hash || block->size != size || memcmp(block->data, data, size)))
+			block = block->next;
+	}
+	if (!block && section_store.bucket_count) {
+		block = (section_block_t*)memory_alloc(MEMORY_COLD, sizeof(section_block_t) + size);
+		if (block) {
+			*block = (section_block_t){ .next = section_store.buckets[hash % section_store.bucket_count], .hash = hash, .size = size };
+			memcpy(block->data, data, size);
+			section_store.buckets[hash % section_store.bucket_count] = block;
+			section_store.block_count++;
+		}
+	}
+	if (block) {
+		block->references++;
+		section_store.references++;
+	}
+	pthread_mutex_unlock(&section_store.lock);
+	return block;
+}
+
+/**
+ * @brief Drop a reference to a block of the section store, freeing the block
+ *        with its last reference, and the buckets with the last block.
+ * @param[in] block The block, or NULL.
+ */
+static void section_release(section_block_t* const block) {
+	if (!block)
+		return;
+	pthread_mutex_lock(&section_store.lock);
+	section_store.references--;
+	if (!--block->references) {
+		section_block_t** link = &section_store.buckets[block->hash % section_store.bucket_count];
+		while (*link != block)
+			link = &(*link)->next;
+		*link = block->next;
+		memory_free(MEMORY_COLD, block);
+		if (!--section_store.block_count) {
+			memory_free(MEMORY_COLD, section_store.buckets);
+			section_store.buckets = NULL;
+			section_store.bucket_count = 0;
+		}
+	}
+	pthread_mutex_unlock(&section_store.lock);
+}
+
+/**
+ * @brief Mark the pages overlapping a range of the buffer as resident.
+ * @param[in,out] tensor3 The third-order tensor whose pages are resident.
+ * @param[in] start The first byte of the range.
+ * @param[in] end One past the last byte of the range.
+ */
+static void tensor3_pages_resident(tensor3_t* const tensor3, const uint32_t start, const uint32_t end) {
+	cold_store_t* cold = tensor3->cold;
+	for (uint32_t page = start / cold->page_size; page <= (end - 1) / cold->page_size; page++)
+		cold->released[page] = false;
+}
+
+/**
+ * @brief Release the pages overlapping a range of the buffer that hold no
+ *        hot section.
+ * @param[in,out] tensor3 The third-order tensor whose pages to release.
+ * @param[in] start The first byte of the range.
+ * @param[in] end One past the last byte of the range.
+ *
+ * The contents of cold sections are kept in their compressed blocks, so the
+ * kernel may discard their pages; they read as zeros until thawed again.
+ */
+static void tensor3_pages_release(tensor3_t* const tensor3, const uint32_t start, const uint32_t end) {
+	cold_store_t* cold = tensor3->cold;
+	for (uint32_t page = start / cold->page_size; page <= (end - 1) / cold->page_size; page++) {
+		if (cold->released[page])
+			continue;
+		const uint32_t first = page * cold->page_size / tensor3->section_size;
+		const uint32_t last = ((page + 1) * cold->page_size - 1) / tensor3->section_size;
+		const uint32_t units = (uint32_t)tensor3->channels * tensor3->dimension;
+		bool releasable = true;
+		for (uint32_t unit = first; releasable && unit <= last && unit < units; unit++)
+			releasable = cold->blocks[unit] != NULL;
+		if (releasable && !madvise(tensor3->buffer + page * cold->page_size, cold->page_size, MADV_DONTNEED))
+			cold->released[page] = true;
+	}
+}
+
+/**
+ * @brief Recompute the checksums of a range of sections.
+ * @param[in,out] context The checksum_range_t to recompute.
+ * @param[in] begin The first iteration to recompute.
+ * @param[in] end One past the last iteration to recompute.
+ * @return true
+ */
+static bool checksum_sections(void* const context, const uint32_t begin, const uint32_t end) {
+	const checksum_range_t* const range = (const checksum_range_t*)context;
+	tensor3_t* const tensor3 = range->tensor3;
+	for (uint32_t i = begin; i < end; i++) {
+		const uint32_t channel = i / range->count;
+		const uint32_t section = (range->first + i % range->count) % tensor3->dimension;
+		const uint32_t unit = channel * tensor3->dimension + section;
+		tensor3->checksums[unit] = crc32c(tensor3->buffer + unit * tensor3->section_size, tensor3->section_size);
+	}
+	return true;
+}
+
+/**
+ * @brief Recompute the checksums of the sections an operation rewrote, in
+ *        parallel.
+ * @param[in,out] tensor3 The third-order tensor, whose sections in the range
+ *                must be hot.
+ * @param[in] first The first section of the range, as stored in the buffer.
+ * @param[in] count The number of sections, wrapping around the last one.
+ * @return true
+ */
+static bool tensor3_checksum_sections(tensor3_t* const tensor3, const uint8_t first, const uint8_t count) {
+	if (!tensor3->checksums || !count)
+		return true;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	checksum_range_t range = { .tensor3 = tensor3, .first = first, .count = count };
+	const bool result = parallel_for((uint32_t)tensor3->channels * count, checksum_sections, &range);
+	metrics_observe(tensor3->metrics, OPERATION_CHECKSUM, &start, (uint64_t)tensor3->channels * count * tensor3->section_size);
+	return result;
+}
+
+/**
+ * @brief Move the checksums of whole sections along with the sections,
+ *        instead of recomputing them.
+ * @param[in,out] tensor3 The third-order tensor whose sections moved.
+ * @param[in] shift The number of sections every section moved down, wrapping
+ *            around the first one.
+ * @param[in] reverse Whether the order of the sections was reversed instead.
+ *
+ * Section s takes the checksum of section (s + shift) % dimension, or of
+ * section dimension - 1 - s when reversed, in every channel.
+ */
+static void tensor3_checksum_remap(tensor3_t* const tensor3, const uint8_t shift, const bool reverse) {
+	if (!tensor3->checksums)
+		return;
+	const uint8_t dimension = tensor3->dimension;
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		uint32_t* const checksums = tensor3->checksums + channel * dimension;
+		uint32_t previous[UINT8_MAX];
+		memcpy(previous, checksums, dimension * sizeof(uint32_t));
+		for (uint8_t section = 0; section < dimension; section++)
+			checksums[section] = previous[reverse ? dimension - 1 - section : (section + shift) % dimension];
+	}
+}
+
+/**
+ * @brief Check a hot section against its checksums.
+ * @param[in] tensor3 The third-order tensor owning the section.
+ * @param[in] section The section to check, as stored in the buffer.
+ * @return true if every channel of the section matches its checksum or no
+ *         checksums are kept, false otherwise
+ *
+ * Every channel failing its checksum is reported on stderr.
+ */
+static bool tensor3_section_intact(const tensor3_t* const tensor3, const uint8_t section) {
+	if (!tensor3->checksums)
+		return true;
+	bool intact = true;
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		const uint32_t unit = channel * tensor3->dimension + section;
+		if (crc32c(tensor3->buffer + unit * tensor3->section_size, tensor3->section_size) != tensor3->checksums[unit]) {
+			fprintf(stderr, "section %u of channel %u failed its checksum\n", section, channel);
+			intact = false;
+		}
+	}
+	return intact;
+}
+
+/**
+ * @brief Compress a hot section into its cold block.
+ * @param[in,out] tensor3 The third-order tensor owning the section.
+ * @param[in] section The section to compress.
+ * @return true if the section was compressed, false otherwise
+ */
+static bool tensor3_section_freeze(tensor3_t* const tensor3, const uint8_t section) {
+	cold_store_t* cold = tensor3->cold;
+	if (cold->blocks[section])
+		return true;
+	uint8_t* const compressed = (uint8_t*)memory_alloc(MEMORY_COLD, lz_bound(tensor3->section_size));
+	if (!compressed)
+		return false;
+	section_block_t* blocks[TENSOR3_CHANNELS_MAX];
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		const uint32_t start = (channel * tensor3->dimension + section) * tensor3->section_size;
+		blocks[channel] = section_intern(
+			compressed,
+			lz_compress(tensor3->buffer + start, tensor3->section_size, compressed));
+		if (!blocks[channel]) {
+			while (channel)
+				section_release(blocks[--channel]);
+			memory_free(MEMORY_COLD, compressed);
+			return false;
+		}
+	}
+	memory_free(MEMORY_COLD, compressed);
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		const uint32_t unit = channel * tensor3->dimension + section;
+		const uint32_t start = unit * tensor3->section_size;
+		cold->blocks[unit] = blocks[channel];
+		tensor3_pages_release(tensor3, start, start + tensor3->section_size);
+	}
+	return true;
+}
+
+/**
+ * @brief Decompress a cold section back into the buffer, checking it
+ *        against its checksums.
+ * @param[in,out] tensor3 The third-order tensor owning the section.
+ * @param[in] section The section to decompress.
+ * @return true if the section is hot and intact, false otherwise
+ */
+static bool tensor3_section_thaw(tensor3_t* const tensor3, const uint8_t section) {
+	cold_store_t* cold = tensor3->cold;
+	if (!cold->blocks[section])
+		return true;
+	// the block of the first channel is released last, as it marks the section cold
+	for (uint8_t channel = tensor3->channels; channel-- > 0;) {
+		const uint32_t unit = channel * tensor3->dimension + section;
+		const uint32_t start = unit * tensor3->section_size;
+		tensor3_pages_resident(tensor3, start, start + tensor3->section_size);
+		if (!lz_decompress(cold->blocks[unit]->data, cold->blocks[unit]->size, tensor3->buffer + start, tensor3->section_size))
+			return false;
+		section_release(cold->blocks[unit]);
+		cold->blocks[unit] = NULL;
+	}
+	return tensor3_section_intact(tensor3, section);
+}
+
+/**
+ * @brief Compress the least recently used sections until no more than the
+ *        configured number of sections are hot.
+ * @param[in,out] tensor3 The third-order tensor to compress sections of.
+ */
+static void tensor3_cold_evict(tensor3_t* const tensor3) {
+	cold_store_t* cold = tensor3->cold;
+	if (!cold)
+		return;
+	uint8_t hot = 0;
+	for (uint8_t section = 0; section < tensor3->dimension; section++)
+		hot += !cold->blocks[section];
+	while (hot > cold->hot_max) {
+		uint8_t lru = UINT8_MAX;
+		for (uint8_t section = 0; section < tensor3->dimension; section++)
+			if (!cold->blocks[section] && (lru == UINT8_MAX || cold->last_use[section] < cold->last_use[lru]))
+				lru = section;
+		if (!tensor3_section_freeze(tensor3, lru))
+			return;
+		hot--;
+	}
+}
+
+/**
+ * @brief Make a section hot and mark it as the most recently used.
+ * @param[in,out] tensor3 The third-order tensor owning the section.
+ * @param[in] section The section about to be accessed.
+ * @return true if the section is hot, false otherwise
+ */
+bool tensor3_section_touch(tensor3_t* const tensor3, const uint8_t* const section) {
+	cold_store_t* cold = tensor3->cold;
+	if (!cold)
+		return true;
+	if (!tensor3_section_thaw(tensor3, *section))
+		return false;
+	cold->last_use[*section] = ++cold->clock;
+	tensor3_cold_evict(tensor3);
+	return true;
+}
+
+/**
+ * @brief Make every section hot, ahead of an operation on the whole tensor.
+ * @param[in,out] tensor3 The third-order tensor to decompress.
+ * @return true if every section is hot, false otherwise
+ *
+ * Call tensor3_cold_evict afterwards to compress the cold sections again.
+ */
+bool tensor3_thaw_all(tensor3_t* const tensor3) {
+	if (!tensor3->cold)
+		return true;
+	for (uint8_t section = 0; section < tensor3->dimension; section++)
+		if (!tensor3_section_thaw(tensor3, section))
+			return false;
+	return true;
+}
+
+/**
+ * @brief Enable in-memory compression of cold sections.
+ * @param[in,out] tensor3 The initialized third-order tensor.
+ * @param[in] hot_max The number of recently used sections kept decompressed.
+ * @return true if the cold store was created, false otherwise
+ *
+ * The buffer must be page-aligned and padded to a whole number of pages.
+ */
+static bool tensor3_cold_init(tensor3_t* const tensor3, const uint8_t* const hot_max) {
+	cold_store_t* cold = (cold_store_t*)memory_calloc(MEMORY_COLD, 1, sizeof(cold_store_t));
+	if (!cold)
+		return false;
+	cold->page_size = (uint32_t)sysconf(_SC_PAGESIZE);
+	cold->hot_max = *hot_max ? *hot_max : 1;
+	const uint32_t units = (uint32_t)tensor3->channels * tensor3->dimension;
+	cold->blocks = (section_block_t**)memory_calloc(MEMORY_COLD, units, sizeof(section_block_t*));
+	cold->last_use = (uint32_t*)memory_calloc(MEMORY_COLD, tensor3->dimension, sizeof(uint32_t));
+	cold->released = (bool*)memory_calloc(MEMORY_COLD, ((size_t)tensor3->channels * tensor3->size + cold->page_size - 1) / cold->page_size, sizeof(bool));
+	if (!cold->blocks || !cold->last_use || !cold->released) {
+		memory_free(MEMORY_COLD, cold->blocks);
+		memory_free(MEMORY_COLD, cold->last_use);
+		memory_free(MEMORY_COLD, cold->released);
+		memory_free(MEMORY_COLD, cold);
+		return false;
+	}
+	tensor3->cold = cold;
+	tensor3_cold_evict(tensor3);
+	return true;
+}
+
+/**
+ * @brief Disable in-memory compression of cold sections, freeing the
+ *        compressed blocks.
+ * @param[in,out] tensor3 The third-order tensor, whose sections must all be
+ *                hot unless the buffer is about to be freed.
+ */
+static void tensor3_cold_free(tensor3_t* const tensor3) {
+	cold_store_t* const cold = tensor3->cold;
+	if (!cold)
+		return;
+	for (uint32_t unit = 0; unit < (uint32_t)tensor3->channels * tensor3->dimension; unit++)
+		section_release(cold->blocks[unit]);
+	memory_free(MEMORY_COLD, cold->blocks);
+	memory_free(MEMORY_COLD, cold->last_use);
+	memory_free(MEMORY_COLD, cold->released);
+	memory_free(MEMORY_COLD, cold);
+	tensor3->cold = NULL;
+}
+
+/**
+ * @brief Read a slab of sections of a raw volume file into a tensor.
+ * @param[in,out] context The tensor3_import_t describing the import.
+ * @param[in] begin The first section to read.
+ * @param[in] end One past the last section to read.
+ * @return true if the slab was read completely, false otherwise
+ *
+ * Sections are stored contiguously in both the file and the buffer, so each
+ * slab is read with positional reads directly into its final location.
+ */
+static bool tensor3_import_slab(void* const context, const uint32_t begin, const uint32_t end) {
+	tensor3_import_t* import = (tensor3_import_t*)context;
+	const off_t slab_end = (off_t)end * import->tensor3->section_size;
+	off_t offset = (off_t)begin * import->tensor3->section_size;
+	while (offset < slab_end) {
+		ssize_t bytes = pread(import->fd, import->tensor3->buffer + offset, slab_end - offset, offset);
+		if (bytes < 0 && errno == EINTR)
+			continue;
+		if (bytes <= 0)
+			return false;
+		offset += bytes;
+	}
+	return true;
+}
+
+/**
+ * @brief Import the elements of a third-order tensor from a raw volume file.
+ * @param[in,out] tensor3 The allocated third-order tensor to fill.
+ * @param[in] path The path of the raw volume file.
+ * @return true if the volume was imported, false otherwise
+ *
+ * The file holds one byte per element and channel in buffer order, plane
+ * after plane, and must contain at least as many bytes as the buffer. Slabs
+ * of sections are read in parallel, unless the tensor compresses its cold
+ * sections: then the sections are read one after the other, each made hot
+ * first, so that only the hot ones are ever resident. Every section read is
+ * checksummed.
+ */
+static bool tensor3_import(tensor3_t* const tensor3, const char* const path) {
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	tensor3_import_t import = { .tensor3 = tensor3, .fd = open(path, O_RDONLY) };
+	if (import.fd < 0)
+		return false;
+	struct stat status;
+	bool result = !fstat(import.fd, &status)
+		&& status.st_size >= (off_t)tensor3->channels * tensor3->size;
+	if (tensor3->cold) {
+		for (uint8_t section = 0; result && section < tensor3->dimension; section++) {
+			result = tensor3_section_touch(tensor3, &section);
+			for (uint8_t channel = 0; result && channel < tensor3->channels; channel++) {
+				const uint32_t unit = channel * tensor3->dimension + section;
+				result = tensor3_import_slab(&import, unit, unit + 1);
+			}
+			result = result && tensor3_checksum_sections(tensor3, section, 1);
+		}
+	} else {
+		result = result
+			&& parallel_for((uint32_t)tensor3->channels * tensor3->dimension, tensor3_import_slab, &import)
+			&& tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	}
+	close(import.fd);
+	if (result) {
+		const double seconds = clock_elapsed(&start);
+		const uint32_t bytes = tensor3->channels * tensor3->size;
+		fprintf(stderr, "imported %u bytes from %s in %.3f ms (%.3f GB/s)\n",
+			bytes, path, seconds * 1e3, seconds > 0 ? bytes / seconds / 1e9 : 0.0);
+	}
+	return result;
+}
+
+/**
+ * @brief Describe the region covering a whole third-order tensor.
+ * @param[in] tensor3 The third-order tensor to describe.
+ * @return The region with the origin at zero and the tensor's dimension.
+ */
+static region_t tensor3_whole(const tensor3_t* const tensor3) {
+	return (region_t){ .origin = { 0, 0, 0 }, .edge = tensor3->dimension };
+}
+
+/**
+ * @brief Calculate the index of a third-order tensor given a coordinate.
+ * @param[in] coord A coordinate structure to convert to an index.
+ * @param[in] tensor3 The third-order tensor to calculate the index for.
+ * @return The calculated index.
+ *
+ * Formula: index = x + (y * width) + (z * width * height)
+ *
+ * Each coordinate is first moved by the tensor's origin, wrapping around.
+ */
+uint32_t tensor3_coord_to_index(
+	const coordinate_t* const coord,
+	const tensor3_t* const tensor3
+) {
+	const uint8_t dimension = tensor3->dimension;
+	const uint32_t x = (coord->x + tensor3->origin[0]) % dimension;
+	const uint32_t y = (coord->y + tensor3->origin[1]) % dimension;
+	const uint32_t z = (coord->z + tensor3->origin[2]) % dimension;
+	return x + (y * dimension) + (z * tensor3->section_size);
+}
+
+/**
+ * @brief Convert an index to a corresponding coordinate.
+ * @param[out] coord The coordinate to calculate.
+ * @param[in] idx The index to convert into a coordinate.
+ * @param[in] tensor3 The third-order tensor to calculate the coordinate for.
+ * @return true if the conversion was successful, false otherwise
+ *
+ * Every time the index increases by one width, the x value resets.
+ * x = index % width
+ *
+ * When the index increases by one width, the height increases by one. Once the
+ * index increases by width times height, the y value resets.
+ * y = (index / width) % height
+ *
+ * As the index increases by width times height, the z value increases by one.
+ * z = index / (width * height)
+ *
+ * Each value is then moved back by the tensor's origin, wrapping around.
+ */
+[[maybe_unused]] static bool tensor3_index_to_coord(
+	coordinate_t* const coord,
+	const uint32_t* const idx,
+	const tensor3_t* const tensor3
+) {
+	if (*idx >= tensor3->size)
+		return false;
+	const uint8_t dimension = tensor3->dimension;
+	coord->x = (*idx % dimension + dimension - tensor3->origin[0]) % dimension;
+	coord->y = ((*idx / dimension) % dimension + dimension - tensor3->origin[1]) % dimension;
+	coord->z = (*idx / tensor3->section_size + dimension - tensor3->origin[2]) % dimension;
+	return true;
+}
+
+/**
+ * @brief Calculate a quartet of coordinates to rotate in a third-order tensor.
+ * @param[out] quartet The quartet of coordinates under calculation.
+ * @param[in] region The cubic region of the tensor being rotated.
+ * @param[in] section The section of the tensor to calculate the quartet for.
+ * @param[in] layer The layer within the section.
+ * @param[in] offset The offset within the layer.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the calculation was successful, false otherwise
+ */
+static bool tensor3_calculate_quartet(
+	quartet_t* const quartet,
+	const region_t* const region,
+	const uint8_t* const section,
+	const uint8_t* const layer,
+	const uint8_t* const offset,
+	const axis_t* const axis
+) {
+	if (*section >= region->edge
+		|| *layer >= region->edge / 2
+		|| *offset >= region->edge - 1 - 2 * *layer)
+		return false;
+	switch (*axis) {
+		case AXIS_XPOSITIVE:
+			*quartet = (quartet_t){
+				.first = (coordinate_t){
+					.x = *section,
+					.y = *layer,
+					.z = region->edge - 1 - *layer - *offset
+				},
+				.second = (coordinate_t){
+					.x = *section,
+					.y = *layer + *offset,
+					.z = *layer
+				},
+				.third = (coordinate_t){
+					.x = *section,
+					.y = region->edge - 1 - *layer,
+					.z = *layer + *offset
+				},
+				.fourth = (coordinate_t){
+					.x = *section,
+					.y = region->edge - 1 - *layer - *offset,
+					.z = region->edge - 1 - *layer
+				}
+			};
+			break;
+		case AXIS_XNEGATIVE:
+			*quartet = (quartet_t){
+				.first = (coordinate_t){
+					.x = region->edge - 1 - *section,
+					.y = *layer,
+					.z = *layer + *offset
+				},
+				.second = (coordinate_t){
+					.x = region->edge - 1 - *section,
+					.y = *layer + *offset,
+					.z = region->edge - 1 - *layer
+				},
+				.third = (coordinate_t){
+					.x = region->edge - 1 - *section,
+					.y = region->edge - 1 - *layer,
+					.z = region->edge - 1 - *layer - *offset
+				},
+				.fourth = (coordinate_t){
+					.x = region->edge - 1 - *section,
+					.y = region->edge - 1 - *layer - *offset,
+					.z = *layer
+				}
+			};
+			break;
+		case AXIS_YPOSITIVE:
+			*quartet = (quartet_t){
+				.first = (coordinate_t){
+					.x = *layer + *offset,
+					.y = *section,
+					.z = region->edge - 1 - *layer
+				},
+				.second = (coordinate_t){
+					.x = region->edge - 1 - *layer,
+					.y = *section,
+					.z = region->edge - 1 - *layer - *offset
+				},
+				.third = (coordinate_t){
+					.x = region->edge - 1 - *layer - *offset,
+					.y = *section,
+					.z = *layer
+				},
+				.fourth = (coordinate_t){
+					.x = *layer,
+					.y = *section,
+					.z = *layer + *offset
+				},
+			};
+			break;
+		case AXIS_YNEGATIVE:
+			*quartet = (quartet_t){
+				.first = (coordinate_t){
+					.x = *layer + *offset,
+					.y = region->edge - 1 - *section,
+					.z = *layer
+				},
+				.second = (coordinate_t){
+					.x = region->edge - 1 - *layer,
+					.y = region->edge - 1 - *section,
+					.z = *layer + *offset
+				},
+				.third = (coordinate_t){
+					.x = region->edge - 1 - *layer - *offset,
+					.y = region->edge - 1 - *section,
+					.z = region->edge - 1 - *layer
+				},
+				.fourth = (coordinate_t){
+					.x = *layer,
+					.y = region->edge - 1 - *section,
+					.z = region->edge - 1 - *layer - *offset
+				}
+			};
+			break;
+		case AXIS_ZPOSITIVE:
+			*quartet = (quartet_t){
+				.first = (coordinate_t){
+					.x = *layer + *offset,
+					.y = *layer,
+					.z = *section
+				},
+				.second = (coordinate_t){
+					.x = region->edge - 1 - *layer,
+					.y = *layer + *offset,
+					.z = *section
+				},
+				.third = (coordinate_t){
+					.x = region->edge - 1 - *layer - *offset,
+					.y = region->edge - 1 - *layer,
+					.z = *section
+				},
+				.fourth = (coordinate_t){
+					.x = *layer,
+					.y = region->edge - 1 - *layer - *offset,
+					.z = *section
+				}
+			};
+			break;
+		case AXIS_ZNEGATIVE:
+			*quartet = (quartet_t){
+				.first = (coordinate_t){
+					.x = region->edge - 1 - *layer - *offset,
+					.y = *layer,
+					.z = region->edge - 1 - *section
+				},
+				.second = (coordinate_t){
+					.x = *layer,
+					.y = *layer + *offset,
+					.z = region->edge - 1 - *section
+				},
+				.third = (coordinate_t){
+					.x = *layer + *offset,
+					.y = region->edge - 1 - *layer,
+					.z = region->edge - 1 - *section
+				},
+				.fourth = (coordinate_t){
+					.x = region->edge - 1 - *layer,
+					.y = region->edge - 1 - *layer - *offset,
+					.z = region->edge - 1 - *section
+				},
+			};
+			break;
+		default:
+			return false;
+	}
+	// the quartet was calculated within the region; move it into the tensor
+	coordinate_t* const coords[] = { &quartet->first, &quartet->second, &quartet->third, &quartet->fourth };
+	for (uint8_t k = 0; k < 4; k++) {
+		coords[k]->x += region->origin.x;
+		coords[k]->y += region->origin.y;
+		coords[k]->z += region->origin.z;
+	}
+	return true;
+}
+
+/**
+ * @brief Rotate a quartet of coordinates in a layer of a third-order tensor.
+ * @param[in,out] tensor3 The third-order tensor being rotated.
+ * @param[in] region The cubic region of the tensor being rotated.
+ * @param[in] section The section being rotated.
+ * @param[in] layer The layer being rotated.
+ * @param[in] offset The offset within the layer used to calculate the quartet.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ */
+static bool tensor3_rotate_quartet(
+	tensor3_t* const tensor3,
+	const region_t* const region,
+	const uint8_t* const section,
+	const uint8_t* const layer,
+	const uint8_t* const offset,
+	const axis_t* const axis
+) {
+	quartet_t quartet = { 0 };
+	if (!tensor3_calculate_quartet(&quartet, region, section, layer, offset, axis))
+		return false;
+	uint32_t first_idx = tensor3_coord_to_index(&quartet.first, tensor3);
+	uint32_t second_idx = tensor3_coord_to_index(&quartet.second, tensor3);
+	uint32_t third_idx = tensor3_coord_to_index(&quartet.third, tensor3);
+	uint32_t fourth_idx = tensor3_coord_to_index(&quartet.fourth, tensor3);
+	// the indices are shared by every channel's plane
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		uint8_t* plane = tensor3->buffer + channel * tensor3->size;
+		char first = plane[first_idx];
+		char second = plane[second_idx];
+		char third = plane[third_idx];
+		char fourth = plane[fourth_idx];
+		plane[first_idx] = fourth;
+		plane[second_idx] = first;
+		plane[third_idx] = second;
+		plane[fourth_idx] = third;
+	}
+	return true;
+}
+
+/**
+ * @brief Rotate a layer of a cross section of a third-order tensor 90 degrees.
+ * @param[in,out] tensor3 The third-order tensor being rotated.
+ * @param[in] region The cubic region of the tensor being rotated.
+ * @param[in] section The section being rotated.
+ * @param[in] layer The layer to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ */
+static bool tensor3_rotate_layer(
+	tensor3_t* const tensor3,
+	const region_t* const region,
+	const uint8_t* const section,
+	const uint8_t* const layer,
+	const axis_t* const axis
+) {
+	const uint8_t offset_end = region->edge - 1 - 2 * *layer;
+	for (uint8_t offset = 0; offset < offset_end; offset++)
+		if (!tensor3_rotate_quartet(tensor3, region, section, layer, &offset, axis))
+			return false;
+	return true;
+}
+
+/**
+ * @brief Rotate a cross section of a third-order tensor 90 degrees.
+ * @param[in,out] tensor3 The third-order tensor being rotated.
+ * @param[in] region The cubic region of the tensor being rotated.
+ * @param[in] section The section to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ */
+static bool tensor3_rotate_section(
+	tensor3_t* const tensor3,
+	const region_t* const region,
+	const uint8_t* const section,
+	const axis_t* const axis
+) {
+	for (uint8_t layer = 0; layer < region->edge / 2; layer++)
+		if (!tensor3_rotate_layer(tensor3, region, section, &layer, axis))
+			return false;
+	return true;
+}
+
+/**
+ * @brief Cycle the elements of four equally long rows of a hypercube.
+ * @param[in,out] first The row whose elements move to the second row.
+ * @param[in,out] second The row whose elements move to the third row.
+ * @param[in,out] third The row whose elements move to the fourth row.
+ * @param[in,out] fourth The row whose elements move to the first row.
+ * @param[in] length The number of elements in each row.
+ *
+ * The rows never overlap, which lets the compiler vectorize the loop.
+ */
+static void hypercube_cycle_rows(
+	uint8_t* restrict const first,
+	uint8_t* restrict const second,
+	uint8_t* restrict const third,
+	uint8_t* restrict const fourth,
+	const uint32_t length
+) {
+	for (uint32_t k = 0; k < length; k++) {
+		const uint8_t carry = fourth[k];
+		fourth[k] = third[k];
+		third[k] = second[k];
+		second[k] = first[k];
+		first[k] = carry;
+	}
+}
+
+/**
+ * @brief Rotate a hypercube 90 degrees within the plane of two of its axes.
+ * @param[in,out] cube The hypercube to rotate.
+ * @param[in] i The first axis of the plane of rotation.
+ * @param[in] j The second axis of the plane of rotation.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * The element at coordinate a_i along axis i and a_j along axis j moves to
+ * extent - 1 - a_j along axis i and a_i along axis j; swapping i and j
+ * reverses the direction. As in tensor3_calculate_quartet, every plane is
+ * rotated in place in quartets, layer by layer, for every combination of the
+ * coordinates along the remaining axes. If the fastest axis (stride 1) is not
+ * part of the plane, the quartets are whole contiguous rows along it.
+ */
+static bool hypercube_rotate(const hypercube_t* const cube, const uint8_t* const i, const uint8_t* const j) {
+	if (*i >= cube->rank || *j >= cube->rank || *i == *j || cube->extents[*i] != cube->extents[*j])
+		return false;
+	const uint32_t n = cube->extents[*i];
+	const size_t stride_i = cube->strides[*i], stride_j = cube->strides[*j];
+	const bool rows = *i && *j && cube->strides[0] == 1;
+	const uint32_t row_length = rows ? cube->extents[0] : 1;
+	uint8_t outer[HYPERCUBE_RANK_MAX];
+	uint8_t outer_count = 0;
+	for (uint8_t axis = rows ? 1 : 0; axis < cube->rank; axis++) {
+		if (!cube->extents[axis])
+			return true;
+		if (axis != *i && axis != *j)
+			outer[outer_count++] = axis;
+	}
+	uint32_t counters[HYPERCUBE_RANK_MAX] = { 0 };
+	size_t base = 0;
+	while (true) {
+		for (uint32_t layer = 0; layer < n / 2; layer++) {
+			const uint32_t last = n - 1 - layer;
+			for (uint32_t offset = 0; offset < last - layer; offset++)
+				hypercube_cycle_rows(
+					cube->buffer + base + (layer + offset) * stride_i + layer * stride_j,
+					cube->buffer + base + last * stride_i + (layer + offset) * stride_j,
+					cube->buffer + base + (last - offset) * stride_i + last * stride_j,
+					cube->buffer + base + layer * stride_i + (last - offset) * stride_j,
+					row_length);
+		}
+		// advance the coordinates along the remaining axes like an odometer
+		uint8_t k = 0;
+		for (; k < outer_count; k++) {
+			base += cube->strides[outer[k]];
+			if (++counters[k] < cube->extents[outer[k]])
+				break;
+			base -= cube->strides[outer[k]] * cube->extents[outer[k]];
+			counters[k] = 0;
+		}
+		if (k == outer_count)
+			return true;
+	}
+}
+
+/**
+ * @brief Copy a hypercube into another buffer with its axes permuted and
+ *        reflected, in a single pass.
+ * @param[in] cube The hypercube to copy.
+ * @param[out] destination A buffer laid out with the same strides as the cube.
+ * @param[in] permutation The source axis of every destination axis.
+ * @param[in] reflections Whether every destination axis is reversed.
+ * @return true if the copy was successful, false otherwise
+ *
+ * The element at coordinate s moves to the coordinate d with
+ * d[k] = s[permutation[k]], or extent - 1 - s[permutation[k]] if axis k is
+ * reflected. Each destination row along the fastest axis is gathered with a
+ * constant source step, and copied as a whole when that step is 1.
+ */
+static bool hypercube_permute(
+	const hypercube_t* const cube,
+	uint8_t* const destination,
+	const uint8_t permutation[],
+	const bool reflections[]
+) {
+	bool used[HYPERCUBE_RANK_MAX] = { false };
+	ptrdiff_t steps[HYPERCUBE_RANK_MAX];
+	ptrdiff_t source = 0;
+	for (uint8_t k = 0; k < cube->rank; k++) {
+		if (permutation[k] >= cube->rank || used[permutation[k]]
+			|| cube->extents[k] != cube->extents[permutation[k]])
+			return false;
+		if (!cube->extents[k])
+			return true;
+		used[permutation[k]] = true;
+		const ptrdiff_t stride = (ptrdiff_t)cube->strides[permutation[k]];
+		steps[k] = reflections[k] ? -stride : stride;
+		if (reflections[k])
+			source += stride * (cube->extents[k] - 1);
+	}
+	uint32_t counters[HYPERCUBE_RANK_MAX] = { 0 };
+	size_t base = 0;
+	const uint32_t length = cube->extents[0];
+	while (true) {
+		uint8_t* row = destination + base;
+		if (steps[0] == 1)
+			memcpy(row, cube->buffer + source, length);
+		else
+			for (uint32_t t = 0; t < length; t++)
+				row[t] = cube->buffer[source + steps[0] * (ptrdiff_t)t];
+		uint8_t k = 1;
+		for (; k < cube->rank; k++) {
+			base += cube->strides[k];
+			source += steps[k];
+			if (++counters[k] < cube->extents[k])
+				break;
+			base -= cube->strides[k] * cube->extents[k];
+			source -= steps[k] * (ptrdiff_t)cube->extents[k];
+			counters[k] = 0;
+		}
+		if (k >= cube->rank)
+			return true;
+	}
+}
+
+/**
+ * @brief Describe a third-order tensor as a hypercube.
+ * @param[in] tensor3 The third-order tensor to describe.
+ * @return A rank-4 hypercube whose slowest axis selects the channel.
+ */
+static hypercube_t tensor3_hypercube(const tensor3_t* const tensor3) {
+	return (hypercube_t){
+		.buffer = tensor3->buffer,
+		.rank = 4,
+		.extents = { tensor3->dimension, tensor3->dimension, tensor3->dimension, tensor3->channels },
+		.strides = { 1, tensor3->dimension, tensor3->section_size, tensor3->size }
+	};
+}
+
+/**
+ * @brief Rotate a cubic region of a third-order tensor 90 degrees with the
+ *        hypercube engine.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] region The region to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * The tensor is described as a rank-4 hypercube whose slowest axis selects
+ * the channel, so all channels are rotated in one pass. Rotations about the
+ * x-axis leave the fastest axis untouched and move whole rows.
+ */
+static bool tensor3_rotate_hypercube(
+	tensor3_t* const tensor3,
+	const region_t* const region,
+	const axis_t* const axis
+) {
+	if (*axis > AXIS_ZNEGATIVE)
+		return false;
+	hypercube_t cube = tensor3_hypercube(tensor3);
+	cube.buffer += tensor3_coord_to_index(&region->origin, tensor3);
+	for (uint8_t k = 0; k < 3; k++)
+		cube.extents[k] = region->edge;
+	return hypercube_rotate(&cube, &AXIS_PLANES[*axis][0], &AXIS_PLANES[*axis][1]);
+}
+
+/**
+ * @brief Calculate the coordinate whose element a 90 degree rotation moves to
+ *        a given coordinate.
+ * @param[out] source The coordinate the element is moved from.
+ * @param[in] destination The coordinate the element is moved to.
+ * @param[in] tensor3 The third-order tensor being rotated.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the calculation was successful, false otherwise
+ *
+ * This is the inverse of the movement performed by tensor3_rotate_quartet,
+ * for rotations that write every element into a separate buffer.
+ */
+static bool tensor3_rotate_source(
+	coordinate_t* const source,
+	const coordinate_t* const destination,
+	const tensor3_t* const tensor3,
+	const axis_t* const axis
+) {
+	const uint8_t last = tensor3->dimension - 1;
+	*source = *destination;
+	switch (*axis) {
+		case AXIS_XPOSITIVE:
+			source->y = destination->z;
+			source->z = last - destination->y;
+			break;
+		case AXIS_XNEGATIVE:
+			source->y = last - destination->z;
+			source->z = destination->y;
+			break;
+		case AXIS_YPOSITIVE:
+			source->x = last - destination->z;
+			source->z = destination->x;
+			break;
+		case AXIS_YNEGATIVE:
+			source->x = destination->z;
+			source->z = last - destination->x;
+			break;
+		case AXIS_ZPOSITIVE:
+			source->x = destination->y;
+			source->y = last - destination->x;
+			break;
+		case AXIS_ZNEGATIVE:
+			source->x = last - destination->y;
+			source->y = destination->x;
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Execute a command on the slab owned by a worker process.
+ * @param[in,out] tensor3 The worker's view of the third-order tensor.
+ * @param[in] pool The slab pool the worker belongs to.
+ * @param[in] worker The index of the worker.
+ * @param[in] command The command to execute.
+ * @return true if the command was executed successfully, false otherwise
+ *
+ * A rotation about the z-axis keeps every element within its section, so the
+ * worker rotates its own sections in place. Any other rotation is an
+ * all-to-all exchange: the worker gathers the elements of its slab of the
+ * back buffer from wherever they lie in the front buffer.
+ */
+static bool slab_execute(
+	tensor3_t* const tensor3,
+	const slab_pool_t* const pool,
+	const uint8_t worker,
+	const slab_command_t* const command
+) {
+	const uint8_t begin = (uint8_t)((uint32_t)tensor3->dimension * worker / pool->workers);
+	const uint8_t end = (uint8_t)((uint32_t)tensor3->dimension * (worker + 1) / pool->workers);
+	const axis_t axis = command->axis;
+	const region_t whole = tensor3_whole(tensor3);
+	tensor3->buffer = pool->halves[command->front];
+	if (axis == AXIS_ZPOSITIVE || axis == AXIS_ZNEGATIVE) {
+		for (uint8_t z = begin; z < end; z++) {
+			const uint8_t section = axis == AXIS_ZPOSITIVE ? z : tensor3->dimension - 1 - z;
+			if (!tensor3_rotate_section(tensor3, &whole, &section, &axis))
+				return false;
+		}
+		return true;
+	}
+	uint8_t* const back = pool->halves[!command->front];
+	coordinate_t destination, source;
+	for (destination.z = begin; destination.z < end; destination.z++)
+		for (destination.y = 0; destination.y < tensor3->dimension; destination.y++)
+			for (destination.x = 0; destination.x < tensor3->dimension; destination.x++) {
+				if (!tensor3_rotate_source(&source, &destination, tensor3, &axis))
+					return false;
+				const uint32_t destination_idx = tensor3_coord_to_index(&destination, tensor3);
+				const uint32_t source_idx = tensor3_coord_to_index(&source, tensor3);
+				for (uint32_t plane = 0; plane < (uint32_t)tensor3->channels * tensor3->size; plane += tensor3->size)
+					back[plane + destination_idx] = tensor3->buffer[plane + source_idx];
+			}
+	return true;
+}
+
+/**
+ * @brief Serve commands from the owning process until it goes away.
+ * @param[in] tensor3 The third-order tensor, as seen when the worker forked.
+ * @param[in] pool The slab pool the worker belongs to.
+ * @param[in] worker The index of the worker.
+ */
+static void slab_worker(tensor3_t tensor3, const slab_pool_t* const pool, const uint8_t worker) {
+	const int socket = pool->sockets[worker];
+	slab_command_t command;
+	while (read(socket, &command, sizeof(command)) == sizeof(command)) {
+		const uint8_t reply = slab_execute(&tensor3, pool, worker, &command);
+		if (!fd_write_all(socket, &reply, sizeof(reply)))
+			break;
+	}
+	_exit(0);
+}
+
+/**
+ * @brief Split a third-order tensor into slabs of sections owned by worker
+ *        processes.
+ * @param[in,out] tensor3 The initialized third-order tensor, whose buffer is
+ *                the front half of a shared mapping of twice its size.
+ * @param[in] workers The number of worker processes.
+ * @return true if every worker was started, false otherwise
+ *
+ * The workers share the tensor's memory and receive commands over Unix
+ * sockets, standing in for separate nodes exchanging slabs.
+ */
+static bool tensor3_slabs_init(tensor3_t* const tensor3, const uint8_t* const workers) {
+	slab_pool_t* pool = (slab_pool_t*)memory_calloc(MEMORY_SLABS, 1, sizeof(slab_pool_t));
+	if (!pool)
+		return false;
+	pool->workers = *workers;
+	pool->halves[0] = tensor3->buffer;
+	pool->halves[1] = tensor3->buffer + (size_t)tensor3->channels * tensor3->size;
+	tensor3->slabs = pool;
+	for (uint8_t worker = 0; worker < pool->workers; worker++) {
+		int sockets[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets))
+			return false;
+		pool->sockets[worker] = sockets[1];
+		const pid_t pid = fork();
+		if (pid < 0)
+			return false;
+		pool->pids[worker] = pid;
+		if (!pid) {
+			// inherited descriptors, such as the sockets of sibling workers or
+			// of the workers of other tensors, would keep them from seeing EOF
+			if (sockets[1] > STDERR_FILENO + 1)
+				close_range(STDERR_FILENO + 1, sockets[1] - 1, 0);
+			close_range(sockets[1] + 1, ~0u, 0);
+			slab_worker(*tensor3, pool, worker);
+		}
+		close(sockets[1]);
+		pool->sockets[worker] = sockets[0];
+	}
+	return true;
+}
+
+/**
+ * @brief Rotate a slab-decomposed third-order tensor 90 degrees.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * Every worker processes its slab concurrently. After an all-to-all exchange,
+ * the back buffer becomes the front buffer.
+ */
+static bool tensor3_rotate_slabs(tensor3_t* const tensor3, const axis_t* const axis) {
+	slab_pool_t* pool = tensor3->slabs;
+	const slab_command_t command = { .axis = (uint8_t)*axis, .front = pool->front };
+	bool result = true;
+	for (uint8_t worker = 0; worker < pool->workers; worker++)
+		result = fd_write_all(pool->sockets[worker], &command, sizeof(command)) && result;
+	for (uint8_t worker = 0; worker < pool->workers; worker++) {
+		uint8_t reply = 0;
+		result = read(pool->sockets[worker], &reply, sizeof(reply)) == sizeof(reply) && reply && result;
+	}
+	if (result && *axis != AXIS_ZPOSITIVE && *axis != AXIS_ZNEGATIVE) {
+		pool->front = !pool->front;
+		tensor3->buffer = pool->halves[pool->front];
+	}
+	return result;
+}
+
+/**
+ * @brief Rotate a third-order tensor with compressed cold sections 90 degrees.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise; the elements
+ *         are then undefined
+ *
+ * Rotating about the z-axis keeps every element within its section, so the
+ * sections are streamed: each cold section is decompressed, rotated,
+ * checksummed, and compressed again on its own. Rotating about the x-axis or
+ * y-axis gathers every section from one line of each section, so the
+ * sections are compressed first and the rotated ones are filled in batches
+ * of as many sections as are kept hot. For every batch, each source section
+ * is decompressed into a scratch section in turn and its lines copied into
+ * the batch, which is then checksummed and compressed. At most the hot
+ * sections and the scratch section are decompressed at a time, at the cost
+ * of decompressing the tensor once per batch.
+ */
+static bool tensor3_rotate_cold(tensor3_t* const tensor3, const axis_t* const axis) {
+	const region_t whole = tensor3_whole(tensor3);
+	if (*axis == AXIS_ZPOSITIVE || *axis == AXIS_ZNEGATIVE) {
+		for (uint8_t section = 0; section < tensor3->dimension; section++) {
+			const uint8_t z = *axis == AXIS_ZPOSITIVE ? section : tensor3->dimension - 1 - section;
+			const bool was_cold = tensor3->cold->blocks[z] != NULL;
+			if (!tensor3_section_thaw(tensor3, z)
+				|| !tensor3_rotate_section(tensor3, &whole, &section, axis)
+				|| !tensor3_checksum_sections(tensor3, z, 1)
+				|| (was_cold && !tensor3_section_freeze(tensor3, z)))
+				return false;
+		}
+		return true;
+	}
+	cold_store_t* const cold = tensor3->cold;
+	const uint8_t dimension = tensor3->dimension, last = dimension - 1;
+	const uint32_t units = (uint32_t)tensor3->channels * dimension;
+	for (uint8_t section = 0; section < dimension; section++)
+		if (!tensor3_section_freeze(tensor3, section))
+			return false;
+	section_block_t** const sources = (section_block_t**)memory_alloc(MEMORY_COLD, units * sizeof(section_block_t*));
+	uint8_t* const scratch = (uint8_t*)memory_alloc(MEMORY_COLD, tensor3->section_size);
+	bool result = sources && scratch;
+	if (result)
+		memcpy(sources, cold->blocks, units * sizeof(section_block_t*));
+	const bool about_x = *axis == AXIS_XPOSITIVE || *axis == AXIS_XNEGATIVE;
+	const bool positive = *axis == AXIS_XPOSITIVE || *axis == AXIS_YPOSITIVE;
+	uint16_t taken = 0;
+	for (uint16_t first = 0; result && first < dimension; first += cold->hot_max) {
+		const uint8_t count = (uint8_t)(dimension - first < cold->hot_max ? dimension - first : cold->hot_max);
+		// the source blocks keep the previous elements of the batch
+		taken = first + count;
+		for (uint8_t channel = 0; channel < tensor3->channels; channel++)
+			for (uint8_t z = (uint8_t)first; z < first + count; z++) {
+				const uint32_t unit = channel * dimension + z;
+				cold->blocks[unit] = NULL;
+				tensor3_pages_resident(tensor3, unit * tensor3->section_size, (unit + 1) * tensor3->section_size);
+			}
+		for (uint8_t section = 0; result && section < dimension; section++)
+			for (uint8_t channel = 0; result && channel < tensor3->channels; channel++) {
+				const uint32_t unit = channel * dimension + section;
+				result = lz_decompress(sources[unit]->data, sources[unit]->size, scratch, tensor3->section_size);
+				// every source section is checked against its checksum once
+				if (result && !first && tensor3->checksums
+					&& crc32c(scratch, tensor3->section_size) != tensor3->checksums[unit]) {
+					fprintf(stderr, "section %u of channel %u failed its checksum\n", section, channel);
+					result = false;
+				}
+				// the rotation moves the section into one line of every section
+				const uint8_t fixed = about_x == positive ? last - section : section;
+				for (uint8_t z = (uint8_t)first; result && z < first + count; z++) {
+					uint8_t* const plane = tensor3->buffer + (channel * dimension + z) * tensor3->section_size;
+					for (uint8_t t = 0; t < dimension; t++) {
+						const coordinate_t destination = about_x
+							? (coordinate_t){ t, fixed, z }
+							: (coordinate_t){ fixed, t, z };
+						coordinate_t source;
+						tensor3_rotate_source(&source, &destination, tensor3, axis);
+						plane[destination.x + destination.y * dimension] = scratch[source.x + source.y * dimension];
+					}
+				}
+			}
+		result = result && tensor3_checksum_sections(tensor3, (uint8_t)first, count);
+		for (uint8_t z = (uint8_t)first; result && z < first + count; z++)
+			result = tensor3_section_freeze(tensor3, z);
+	}
+	// sections left unrotated by a failure still hold their source blocks
+	for (uint32_t unit = 0; sources && unit < units; unit++)
+		if (unit % dimension < taken)
+			section_release(sources[unit]);
+	memory_free(MEMORY_COLD, sources);
+	memory_free(MEMORY_COLD, scratch);
+	return result;
+}
+
+/**
+ * @brief Provide the buffer an operation writing every element should fill.
+ * @param[in] tensor3 The third-order tensor about to be rewritten.
+ * @return The back half of a slab-decomposed tensor, or a newly allocated
+ *         buffer, or NULL if the allocation failed.
+ */
+static uint8_t* tensor3_back_buffer(const tensor3_t* const tensor3) {
+	if (tensor3->slabs)
+		return tensor3->slabs->halves[!tensor3->slabs->front];
+	return buffer_alloc((size_t)tensor3->channels * tensor3->size);
+}
+
+/**
+ * @brief Make a filled buffer from tensor3_back_buffer the tensor's buffer.
+ * @param[in,out] tensor3 The third-order tensor being rewritten.
+ * @param[in] back The filled buffer, or NULL to discard it.
+ * @param[in] remapped Whether the checksums were already moved along with
+ *            whole sections by tensor3_checksum_remap; otherwise, those of
+ *            every section are recomputed.
+ */
+static void tensor3_swap_buffer(tensor3_t* const tensor3, uint8_t* const back, const bool remapped) {
+	if (tensor3->slabs) {
+		if (back) {
+			tensor3->slabs->front = !tensor3->slabs->front;
+			tensor3->buffer = back;
+			if (!remapped)
+				tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+		}
+		return;
+	}
+	if (back && tensor3->wrapped) {
+		// the caller owns the buffer, so the result is copied back into it
+		memcpy(tensor3->buffer, back, (size_t)tensor3->channels * tensor3->size);
+		memory_free(MEMORY_TENSOR, back);
+	} else if (back) {
+		memory_free(MEMORY_TENSOR, tensor3->buffer);
+		tensor3->buffer = back;
+	}
+	if (back && !remapped)
+		tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	tensor3_cold_evict(tensor3);
+}
+
+/**
+ * @brief Move the elements of a third-order tensor so that its origin is
+ *        zero again, undoing the wrapping of cyclic shifts.
+ * @param[in,out] tensor3 The third-order tensor to normalize.
+ * @return true if the tensor was normalized, false otherwise
+ *
+ * Every row is copied to the back buffer in a single pass, as at most two
+ * contiguous runs. If only the z-axis origin moved, whole sections move and
+ * their checksums are remapped rather than recomputed.
+ */
+bool tensor3_normalize(tensor3_t* const tensor3) {
+	if (!tensor3->origin[0] && !tensor3->origin[1] && !tensor3->origin[2])
+		return true;
+	if (!tensor3_thaw_all(tensor3))
+		return false;
+	uint8_t* back = tensor3_back_buffer(tensor3);
+	if (!back) {
+		tensor3_cold_evict(tensor3);
+		return false;
+	}
+	const uint8_t dimension = tensor3->dimension;
+	const uint8_t head = dimension - tensor3->origin[0];
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		const uint8_t* const source = tensor3->buffer + channel * tensor3->size;
+		uint8_t* const destination = back + channel * tensor3->size;
+		for (uint8_t z = 0; z < dimension; z++)
+			for (uint8_t y = 0; y < dimension; y++) {
+				const coordinate_t coord = { 0, y, z };
+				const uint8_t* const row = source + tensor3_coord_to_index(&coord, tensor3);
+				uint8_t* const target = destination + y * dimension + z * tensor3->section_size;
+				memcpy(target, row, head);
+				memcpy(target + head, row - tensor3->origin[0], dimension - head);
+			}
+	}
+	const bool remapped = !tensor3->origin[0] && !tensor3->origin[1];
+	if (remapped)
+		tensor3_checksum_remap(tensor3, tensor3->origin[2], false);
+	memset(tensor3->origin, 0, sizeof(tensor3->origin));
+	tensor3_swap_buffer(tensor3, back, remapped);
+	return true;
+}
+
+/**
+ * @brief Grow or shrink a third-order tensor, keeping every element that
+ *        remains inside it at its coordinate.
+ * @param[in,out] tensor3 The third-order tensor to resize.
+ * @param[in] dimension The new dimension.
+ * @return true if the tensor was resized, false otherwise
+ *
+ * Queued symmetries are applied and the origin normalized first. The buffer
+ * is resized with buffer_realloc and the rows are relocated within it in a
+ * single pass: backward when growing, after the buffer grew, so that no row
+ * lands on one yet to be moved, and forward when shrinking, before the buffer
+ * shrinks. Growing fills the new elements in the same pass with the
+ * background of their channel: a space for symbols, zero for intensities.
+ * The cold store and the checksums are rebuilt for the new sections. Tensors
+ * split into slabs or wrapping a caller's buffer cannot be resized.
+ */
+bool tensor3_resize(tensor3_t* const tensor3, const uint8_t dimension) {
+	if (dimension < TENSOR3_DIM_MIN || dimension > TENSOR3_DIM_MAX || tensor3->slabs || tensor3->wrapped)
+		return false;
+	if (dimension == tensor3->dimension)
+		return true;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (!tensor3_flush(tensor3) || !tensor3_normalize(tensor3) || !tensor3_thaw_all(tensor3))
+		return false;
+	uint32_t* const checksums = tensor3->checksums
+		? (uint32_t*)memory_alloc(MEMORY_TENSOR, (size_t)tensor3->channels * dimension * sizeof(uint32_t))
+		: NULL;
+	if (tensor3->checksums && !checksums) {
+		tensor3_cold_evict(tensor3);
+		return false;
+	}
+	const uint8_t hot_max = tensor3->cold ? tensor3->cold->hot_max : 0;
+	tensor3_cold_free(tensor3);
+	const uint8_t previous = tensor3->dimension;
+	const uint16_t previous_section_size = tensor3->section_size;
+	const uint32_t previous_size = tensor3->size;
+	const uint16_t section_size = (uint16_t)(dimension * dimension);
+	const uint32_t size = (uint32_t)section_size * dimension;
+	uint8_t* buffer = tensor3->buffer;
+	if (dimension < previous) {
+		for (uint8_t channel = 0; channel < tensor3->channels; channel++)
+			for (uint8_t z = 0; z < dimension; z++)
+				for (uint8_t y = 0; y < dimension; y++)
+					memmove(
+						buffer + channel * size + z * section_size + y * dimension,
+						buffer + channel * previous_size + z * previous_section_size + y * previous,
+						dimension);
+		// a buffer that cannot shrink merely keeps its unused tail
+		uint8_t* const resized = buffer_realloc(buffer, (size_t)tensor3->channels * size);
+		if (resized)
+			buffer = resized;
+	} else {
+		buffer = buffer_realloc(buffer, (size_t)tensor3->channels * size);
+		if (!buffer) {
+			memory_free(MEMORY_TENSOR, checksums);
+			if (hot_max)
+				tensor3_cold_init(tensor3, &hot_max);
+			return false;
+		}
+		const uint8_t added = dimension - previous;
+		for (uint8_t channel = tensor3->channels; channel-- > 0;) {
+			const uint8_t background = tensor3->intensity_channels >> channel & 1 ? 0 : RESAMPLE_SYMBOL_BACKGROUND;
+			uint8_t* const plane = buffer + channel * size;
+			const uint8_t* const source = buffer + channel * previous_size;
+			memset(plane + previous * section_size, background, (size_t)added * section_size);
+			for (uint8_t z = previous; z-- > 0;) {
+				uint8_t* const section = plane + z * section_size;
+				memset(section + previous * dimension, background, (size_t)added * dimension);
+				for (uint8_t y = previous; y-- > 0;) {
+					memmove(section + y * dimension, source + z * previous_section_size + y * previous, previous);
+					memset(section + y * dimension + previous, background, added);
+				}
+			}
+		}
+	}
+	tensor3->buffer = buffer;
+	tensor3->dimension = dimension;
+	tensor3->section_size = section_size;
+	tensor3->size = size;
+	if (tensor3->section >= dimension)
+		tensor3->section = dimension - 1;
+	if (checksums) {
+		memory_free(MEMORY_TENSOR, tensor3->checksums);
+		tensor3->checksums = checksums;
+		tensor3_checksum_sections(tensor3, 0, dimension);
+	}
+	if (hot_max && !tensor3_cold_init(tensor3, &hot_max))
+		return false;
+	if (tensor3->metrics)
+		atomic_store(&tensor3->metrics->dimension, dimension);
+	const uint8_t kept = dimension < previous ? dimension : previous;
+	metrics_observe(tensor3->metrics, OPERATION_RESIZE, &start, (uint64_t)tensor3->channels * kept * kept * kept);
+	return true;
+}
+
+/**
+ * @brief Hash the elements of a third-order tensor in coordinate order.
+ * @param[in,out] tensor3 The third-order tensor to hash.
+ * @return The 64-bit FNV-1a hash of every channel, section, and row, which
+ *         does not depend on the origin, or 0 if a section could not be
+ *         decompressed.
+ *
+ * Queued symmetries are not part of the hash.
+ */
+uint64_t tensor3_hash(tensor3_t* const tensor3) {
+	if (!tensor3_thaw_all(tensor3))
+		return 0;
+	uint64_t hash = HASH_SEED;
+	const uint8_t dimension = tensor3->dimension;
+	const uint8_t head = dimension - tensor3->origin[0];
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		const uint8_t* const plane = tensor3->buffer + channel * tensor3->size;
+		for (uint8_t z = 0; z < dimension; z++)
+			for (uint8_t y = 0; y < dimension; y++) {
+				// a row wraps around the x-axis origin in at most two runs
+				const coordinate_t coord = { 0, y, z };
+				const uint8_t* const row = plane + tensor3_coord_to_index(&coord, tensor3);
+				hash = block_hash(hash, row, head);
+				hash = block_hash(hash, row - tensor3->origin[0], dimension - head);
+			}
+	}
+	tensor3_cold_evict(tensor3);
+	return hash;
+}
+
+/**
+ * @brief Check every section of a third-order tensor against its checksums.
+ * @param[in,out] tensor3 The third-order tensor to check.
+ * @return The number of sections failing their checksum in any channel
+ *
+ * Cold sections are checked as they are decompressed, and hot ones
+ * directly; every failure is reported on stderr. Tensors keeping no
+ * checksums always pass.
+ */
+uint32_t tensor3_check(tensor3_t* const tensor3) {
+	if (!tensor3->checksums)
+		return 0;
+	uint32_t corrupt = 0;
+	for (uint8_t section = 0; section < tensor3->dimension; section++) {
+		const bool cold = tensor3->cold && tensor3->cold->blocks[section];
+		// a cold section failing its checksum is left hot and is not checked twice
+		if (cold ? !tensor3_section_thaw(tensor3, section) : !tensor3_section_intact(tensor3, section))
+			corrupt++;
+	}
+	tensor3_cold_evict(tensor3);
+	return corrupt;
+}
+
+/**
+ * @brief Shift a third-order tensor cyclically along an axis.
+ * @param[in,out] tensor3 The third-order tensor to shift.
+ * @param[in] axis The axis to shift along: 0, 1, or 2 for x, y, or z.
+ * @param[in] distance The number of elements to shift towards higher
+ *            coordinates; negative distances shift towards lower ones.
+ *
+ * Only the origin moves; the element at coordinate c ends up at coordinate
+ * c + distance, wrapping around.
+ */
+void tensor3_shift(tensor3_t* const tensor3, const uint8_t axis, const int distance) {
+	const int dimension = tensor3->dimension;
+	tensor3->origin[axis] = (uint8_t)(((tensor3->origin[axis] - distance) % dimension + dimension) % dimension);
+}
+
+/**
+ * @brief The symmetry that leaves every element in place.
+ * @return The identity symmetry.
+ */
+symmetry_t symmetry_identity() {
+	return (symmetry_t){ .permutation = { 0, 1, 2 } };
+}
+
+/**
+ * @brief The symmetry of a 90 degree rotation.
+ * @param[in] axis The axis to rotate about.
+ * @return The symmetry moving every element as tensor3_rotate does.
+ */
+symmetry_t symmetry_from_axis(const axis_t* const axis) {
+	symmetry_t symmetry = symmetry_identity();
+	const uint8_t i = AXIS_PLANES[*axis][0], j = AXIS_PLANES[*axis][1];
+	symmetry.permutation[i] = j;
+	symmetry.permutation[j] = i;
+	symmetry.reflections[i] = true;
+	return symmetry;
+}
+
+/**
+ * @brief The symmetry of a reflection.
+ * @param[in] coordinate The coordinate to reverse (0 for x, 1 for y, 2 for z).
+ * @return The symmetry mirroring every element along the coordinate.
+ */
+symmetry_t symmetry_from_mirror(const uint8_t coordinate) {
+	symmetry_t symmetry = symmetry_identity();
+	symmetry.reflections[coordinate] = true;
+	return symmetry;
+}
+
+/**
+ * @brief Check that a symmetry permutes the x, y, and z coordinates.
+ * @param[in] symmetry The symmetry to check, such as one read from a file.
+ * @return true if the permutation holds each of 0, 1, and 2 once, false
+ *         otherwise
+ */
+static bool symmetry_valid(const symmetry_t* const symmetry) {
+	bool used[3] = { false };
+	for (uint8_t k = 0; k < 3; k++) {
+		if (symmetry->permutation[k] > 2 || used[symmetry->permutation[k]])
+			return false;
+		used[symmetry->permutation[k]] = true;
+	}
+	return true;
+}
+
+/**
+ * @brief Fold two symmetries into one.
+ * @param[in] first The symmetry applied first.
+ * @param[in] second The symmetry applied second.
+ * @return The symmetry equivalent to applying first, then second.
+ */
+symmetry_t symmetry_compose(const symmetry_t* const first, const symmetry_t* const second) {
+	symmetry_t symmetry;
+	for (uint8_t k = 0; k < 3; k++) {
+		symmetry.permutation[k] = first->permutation[second->permutation[k]];
+		symmetry.reflections[k] = second->reflections[k] != first->reflections[second->permutation[k]];
+	}
+	return symmetry;
+}
+
+/**
+ * @brief Compare two symmetries.
+ * @param[in] first The first symmetry.
+ * @param[in] second The second symmetry.
+ * @return true if the symmetries move every element alike, false otherwise
+ */
+bool symmetry_equal(const symmetry_t* const first, const symmetry_t* const second) {
+	for (uint8_t k = 0; k < 3; k++)
+		if (first->permutation[k] != second->permutation[k] || first->reflections[k] != second->reflections[k])
+			return false;
+	return true;
+}
+
+/**
+ * @brief Apply any of the 48 symmetries of a cube to a third-order tensor in
+ *        a single pass.
+ * @param[in,out] tensor3 The third-order tensor to transform.
+ * @param[in] symmetry The symmetry to apply.
+ * @return true if the symmetry was applied, false otherwise
+ *
+ * The tensor is described as a rank-4 hypercube, as for the hypercube kernel,
+ * whose channel axis stays in place. A mirror along the z-axis alone reverses
+ * the order of the sections, so their checksums are remapped rather than
+ * recomputed.
+ */
+bool tensor3_apply_symmetry(tensor3_t* const tensor3, const symmetry_t* const symmetry) {
+	if (!tensor3_normalize(tensor3) || !tensor3_thaw_all(tensor3))
+		return false;
+	uint8_t* back = tensor3_back_buffer(tensor3);
+	const hypercube_t cube = tensor3_hypercube(tensor3);
+	const uint8_t permutation[4] = { symmetry->permutation[0], symmetry->permutation[1], symmetry->permutation[2], 3 };
+	const bool reflections[4] = { symmetry->reflections[0], symmetry->reflections[1], symmetry->reflections[2], false };
+	const bool result = back && hypercube_permute(&cube, back, permutation, reflections);
+	if (!result && !tensor3->slabs)
+		memory_free(MEMORY_TENSOR, back);
+	const symmetry_t mirror = symmetry_from_mirror(2);
+	const bool remapped = result && symmetry_equal(symmetry, &mirror);
+	if (remapped)
+		tensor3_checksum_remap(tensor3, 0, true);
+	tensor3_swap_buffer(tensor3, result ? back : NULL, remapped);
+	return result;
+}
+
+/**
+ * @brief Rotate a third-order tensor 90 degrees.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * The kernel is looked up in the tensor's plan for the axis. Every section
+ * changes, so the checksums of all of them are recomputed.
+ */
+bool tensor3_rotate(tensor3_t* const tensor3, const axis_t axis) {
+	if (axis > AXIS_ZNEGATIVE)
+		return false;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	const kernel_t kernel = tensor3->plan[axis];
+	const region_t whole = tensor3_whole(tensor3);
+	// only the in-process quartet kernel addresses elements through the origin
+	bool result = !(tensor3->slabs || tensor3->cold || kernel != KERNEL_QUARTET)
+		|| tensor3_normalize(tensor3);
+	if (!result)
+		return false;
+	if (tensor3->slabs)
+		result = tensor3_rotate_slabs(tensor3, &axis) && tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	else if (tensor3->cold)
+		result = tensor3_rotate_cold(tensor3, &axis);
+	else if (kernel == KERNEL_HYPERCUBE)
+		result = tensor3_rotate_hypercube(tensor3, &whole, &axis) && tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	else if (kernel == KERNEL_PERMUTE) {
+		const symmetry_t rotation = symmetry_from_axis(&axis);
+		result = tensor3_apply_symmetry(tensor3, &rotation);
+	} else {
+		for (uint8_t section = 0; result && section < tensor3->dimension; section++)
+			result = tensor3_rotate_section(tensor3, &whole, &section, &axis);
+		result = result && tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	}
+	metrics_observe(tensor3->metrics, OPERATION_ROTATE, &start, result ? (uint64_t)tensor3->channels * tensor3->size : 0);
+	return result;
+}
+
+/**
+ * @brief Rotate a cubic region of a third-order tensor 90 degrees in place,
+ *        leaving the rest of the tensor untouched.
+ * @param[in,out] tensor3 The third-order tensor to rotate a region of.
+ * @param[in] region The region to rotate, which must lie within the tensor.
+ * @param[in] axis The axis to rotate about.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * The kernel is looked up in the tensor's plan for the axis. The region is
+ * rotated with the hypercube kernel if it is planned and with quartets
+ * otherwise, as the permute kernel only moves whole tensors, so an edit costs
+ * O(k^3) for an edge length of k. Only the sections the region spans are
+ * thawed.
+ */
+bool tensor3_rotate_box(tensor3_t* const tensor3, const region_t* const region, const axis_t* const axis) {
+	if (*axis > AXIS_ZNEGATIVE
+		|| !region->edge
+		|| region->origin.x + region->edge > tensor3->dimension
+		|| region->origin.y + region->edge > tensor3->dimension
+		|| region->origin.z + region->edge > tensor3->dimension)
+		return false;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	const bool hypercube = tensor3->plan[*axis] == KERNEL_HYPERCUBE;
+	// quartets address elements through the origin, so only the hypercube
+	// kernel and the sections of a cold tensor need it folded away
+	if ((tensor3->cold || hypercube) && !tensor3_normalize(tensor3))
+		return false;
+	bool result = true;
+	if (tensor3->cold)
+		for (uint8_t z = region->origin.z; result && z < region->origin.z + region->edge; z++)
+			result = tensor3_section_thaw(tensor3, z);
+	if (result && hypercube)
+		result = tensor3_rotate_hypercube(tensor3, region, axis);
+	else
+		for (uint8_t section = 0; result && section < region->edge; section++)
+			result = tensor3_rotate_section(tensor3, region, &section, axis);
+	// only the sections the region spans are checksummed again
+	result = result && tensor3_checksum_sections(
+		tensor3,
+		(region->origin.z + tensor3->origin[2]) % tensor3->dimension,
+		region->edge);
+	tensor3_cold_evict(tensor3);
+	const uint64_t volume = (uint64_t)region->edge * region->edge * region->edge;
+	metrics_observe(tensor3->metrics, OPERATION_ROTATE_BOX, &start, result ? tensor3->channels * volume : 0);
+	return result;
+}
+
+/**
+ * @brief Sample a plane at the element nearest to a position.
+ * @param[in] plane The plane of one channel to sample.
+ * @param[in] tensor3 The third-order tensor owning the plane.
+ * @param[in] position The x, y, and z coordinates to sample at.
+ * @return The nearest element, or RESAMPLE_SYMBOL_BACKGROUND outside the tensor.
+ */
+static uint8_t resample_nearest(const uint8_t* const plane, const tensor3_t* const tensor3, const float position[3]) {
+	const float x = floorf(position[0] + 0.5f), y = floorf(position[1] + 0.5f), z = floorf(position[2] + 0.5f);
+	if (x < 0 || y < 0 || z < 0 || x >= tensor3->dimension || y >= tensor3->dimension || z >= tensor3->dimension)
+		return RESAMPLE_SYMBOL_BACKGROUND;
+	const coordinate_t coord = { (uint8_t)x, (uint8_t)y, (uint8_t)z };
+	return plane[tensor3_coord_to_index(&coord, tensor3)];
+}
+
+/**
+ * @brief Sample a plane by trilinear interpolation of the eight elements
+ *        surrounding a position.
+ * @param[in] plane The plane of one channel to sample.
+ * @param[in] tensor3 The third-order tensor owning the plane.
+ * @param[in] position The x, y, and z coordinates to sample at.
+ * @return The interpolated value; elements outside the tensor count as 0.
+ */
+static uint8_t resample_trilinear(const uint8_t* const plane, const tensor3_t* const tensor3, const float position[3]) {
+	const float floors[3] = { floorf(position[0]), floorf(position[1]), floorf(position[2]) };
+	float sum = 0.0f;
+	for (uint8_t corner = 0; corner < 8; corner++) {
+		float weight = 1.0f;
+		int32_t coords[3];
+		bool inside = true;
+		for (uint8_t k = 0; k < 3; k++) {
+			const bool upper = corner >> k & 1;
+			const float fraction = position[k] - floors[k];
+			weight *= upper ? fraction : 1.0f - fraction;
+			coords[k] = (int32_t)floors[k] + upper;
+			inside = inside && coords[k] >= 0 && coords[k] < tensor3->dimension;
+		}
+		if (inside) {
+			const coordinate_t coord = { (uint8_t)coords[0], (uint8_t)coords[1], (uint8_t)coords[2] };
+			sum += weight * plane[tensor3_coord_to_index(&coord, tensor3)];
+		}
+	}
+	return (uint8_t)(sum + 0.5f);
+}
+
+/**
+ * @brief Sample the current channel of a third-order tensor at a position.
+ * @param[in] tensor3 The third-order tensor to sample.
+ * @param[in] position The x, y, and z coordinates to sample at.
+ * @return The element nearest to the position, or the interpolated one if the
+ *         channel holds intensities.
+ */
+uint8_t tensor3_sample(const tensor3_t* const tensor3, const float position[3]) {
+	const uint8_t* plane = tensor3->buffer + tensor3->channel * tensor3->size;
+	return tensor3->intensity_channels >> tensor3->channel & 1
+		? resample_trilinear(plane, tensor3, position)
+		: resample_nearest(plane, tensor3, position);
+}
+
+/**
+ * @brief Resample a range of sections of a rotated third-order tensor.
+ * @param[in,out] context The resample_t describing the rotation.
+ * @param[in] begin The first destination section.
+ * @param[in] end One past the last destination section.
+ * @return true
+ *
+ * Every destination element is inverse-mapped into the source tensor. The
+ * sections are processed in square tiles so that the source elements read by
+ * neighbouring rows stay in cache. Along a row of a tile, the source position
+ * advances by the first column of the matrix, so the positions of the whole
+ * row are computed up front in a vectorizable loop and shared by all channels.
+ */
+static bool resample_sections(void* const context, const uint32_t begin, const uint32_t end) {
+	const resample_t* resample = (const resample_t*)context;
+	const tensor3_t* tensor3 = resample->tensor3;
+	const float center = (tensor3->dimension - 1) / 2.0f;
+	float positions[3][RESAMPLE_TILE];
+	for (uint32_t z = begin; z < end; z++)
+		for (uint32_t y0 = 0; y0 < tensor3->dimension; y0 += RESAMPLE_TILE)
+			for (uint32_t x0 = 0; x0 < tensor3->dimension; x0 += RESAMPLE_TILE)
+				for (uint32_t y = y0; y < y0 + RESAMPLE_TILE && y < tensor3->dimension; y++) {
+					const uint32_t length = x0 + RESAMPLE_TILE <= tensor3->dimension ? RESAMPLE_TILE : tensor3->dimension - x0;
+					for (uint8_t k = 0; k < 3; k++) {
+						const float start = center
+							+ resample->matrix[k][0] * (x0 - center)
+							+ resample->matrix[k][1] * (y - center)
+							+ resample->matrix[k][2] * (z - center);
+						const float step = resample->matrix[k][0];
+						for (uint32_t t = 0; t < length; t++)
+							positions[k][t] = start + step * t;
+					}
+					const coordinate_t coord = { (uint8_t)x0, (uint8_t)y, (uint8_t)z };
+					const uint32_t row = tensor3_coord_to_index(&coord, tensor3);
+					for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+						const uint8_t* plane = tensor3->buffer + channel * tensor3->size;
+						uint8_t* destination = resample->destination + channel * tensor3->size + row;
+						const bool trilinear = tensor3->intensity_channels >> channel & 1;
+						for (uint32_t t = 0; t < length; t++) {
+							const float position[3] = { positions[0][t], positions[1][t], positions[2][t] };
+							destination[t] = trilinear
+								? resample_trilinear(plane, tensor3, position)
+								: resample_nearest(plane, tensor3, position);
+						}
+					}
+				}
+	return true;
+}
+
+/**
+ * @brief Build the matrix mapping destination offsets to source offsets for
+ *        a rotation by an arbitrary angle.
+ * @param[out] matrix The inverse of the rotation, within the axis's plane.
+ * @param[in] axis The axis to rotate about.
+ * @param[in] degrees The angle of rotation; 90 matches tensor3_rotate.
+ */
+void resample_matrix(float matrix[3][3], const axis_t* const axis, const double* const degrees) {
+	const double radians = *degrees * M_PI / 180.0;
+	const uint8_t i = AXIS_PLANES[*axis][0], j = AXIS_PLANES[*axis][1];
+	for (uint8_t row = 0; row < 3; row++)
+		for (uint8_t column = 0; column < 3; column++)
+			matrix[row][column] = row == column;
+	matrix[i][i] = (float)cos(radians);
+	matrix[i][j] = (float)sin(radians);
+	matrix[j][i] = (float)-sin(radians);
+	matrix[j][j] = (float)cos(radians);
+}
+
+/**
+ * @brief Resample a third-order tensor rotated by an arbitrary angle.
+ * @param[in] tensor3 The third-order tensor to rotate.
+ * @param[out] destination A buffer of the same size as the tensor's buffer.
+ * @param[in] axis The axis to rotate about.
+ * @param[in] degrees The angle of rotation; 90 matches tensor3_rotate.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * The tensor rotates about its center. Symbol channels take the nearest
+ * source element and intensity channels are interpolated trilinearly.
+ * Destination elements mapped from outside the tensor become background.
+ * Sections are resampled in parallel.
+ */
+static bool tensor3_resample(
+	const tensor3_t* const tensor3,
+	uint8_t* const destination,
+	const axis_t* const axis,
+	const double* const degrees
+) {
+	if (*axis > AXIS_ZNEGATIVE)
+		return false;
+	resample_t resample = { .tensor3 = tensor3, .destination = destination };
+	resample_matrix(resample.matrix, axis, degrees);
+	return parallel_for(tensor3->dimension, resample_sections, &resample);
+}
+
+/**
+ * @brief Rotate a third-order tensor by an arbitrary angle, replacing its
+ *        elements with the resampled ones.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] axis The axis to rotate about.
+ * @param[in] degrees The angle of rotation.
+ * @return true if the rotation was successful, false otherwise
+ *
+ * The resampled elements are written to the tensor's back buffer.
+ */
+bool tensor3_rotate_angle(tensor3_t* const tensor3, const axis_t* const axis, const double* const degrees) {
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (!tensor3_normalize(tensor3) || !tensor3_thaw_all(tensor3))
+		return false;
+	uint8_t* back = tensor3_back_buffer(tensor3);
+	const bool result = back && tensor3_resample(tensor3, back, axis, degrees);
+	if (!result && !tensor3->slabs)
+		memory_free(MEMORY_TENSOR, back);
+	tensor3_swap_buffer(tensor3, result ? back : NULL, false);
+	metrics_observe(tensor3->metrics, OPERATION_ROTATE_ANGLE, &start, result ? (uint64_t)tensor3->channels * tensor3->size : 0);
+	return result;
+}
+
+/**
+ * @brief Queue a symmetry to be applied by the next tensor3_flush.
+ * @param[in,out] tensor3 The third-order tensor to transform.
+ * @param[in] symmetry The symmetry to queue.
+ */
+void tensor3_queue(tensor3_t* const tensor3, const symmetry_t* const symmetry) {
+	tensor3->pending = symmetry_compose(&tensor3->pending, symmetry);
+}
+
+/**
+ * @brief Apply the queued symmetries.
+ * @param[in,out] tensor3 The third-order tensor to transform.
+ * @return true if the queued symmetries were applied, false otherwise
+ *
+ * The queue holds the composition of its symmetries, so nothing is executed
+ * if they cancel out. A lone 90 degree rotation runs through tensor3_rotate
+ * and its kernels; anything else takes a single tensor3_apply_symmetry pass.
+ */
+bool tensor3_flush(tensor3_t* const tensor3) {
+	const symmetry_t identity = symmetry_identity();
+	if (symmetry_equal(&tensor3->pending, &identity))
+		return true;
+	const symmetry_t pending = tensor3->pending;
+	tensor3->pending = identity;
+	for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++) {
+		const symmetry_t rotation = symmetry_from_axis(&axis);
+		if (symmetry_equal(&pending, &rotation))
+			return tensor3_rotate(tensor3, axis);
+	}
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	const bool result = tensor3_apply_symmetry(tensor3, &pending);
+	metrics_observe(tensor3->metrics, OPERATION_SYMMETRY, &start, result ? (uint64_t)tensor3->channels * tensor3->size : 0);
+	return result;
+}
+
+
+/**
+ * @brief Measure the throughput of rotating a third-order tensor.
+ * @param[in,out] tensor3 The third-order tensor to rotate.
+ * @param[in] count The number of rotations, cycling through every axis.
+ * @return true if every rotation was successful, false otherwise
+ */
+bool tensor3_benchmark(tensor3_t* const tensor3, const uint32_t* const count) {
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (uint32_t i = 0; i < *count; i++)
+		if (!tensor3_rotate(tensor3, (axis_t)(i % (AXIS_ZNEGATIVE + 1))))
+			return false;
+	const double seconds = clock_elapsed(&start);
+	bool uniform = true;
+	for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++)
+		uniform = uniform && tensor3->plan[axis] == tensor3->plan[AXIS_XPOSITIVE];
+	printf("dimension %u, kernel %s, workers %u: %u rotations in %.3f ms (%.3f us/rotation, %.3f GB/s)\n",
+		tensor3->dimension,
+		uniform ? KERNEL_NAMES[tensor3->plan[AXIS_XPOSITIVE]] : "tuned",
+		tensor3->slabs ? tensor3->slabs->workers : 0,
+		*count,
+		seconds * 1e3,
+		*count ? seconds * 1e6 / *count : 0.0,
+		seconds > 0 ? (double)tensor3->channels * tensor3->size * *count / seconds / 1e9 : 0.0);
+	return true;
+}
+
+/**
+ * @brief Read the model name of the processor.
+ * @param[out] model The model name, or "unknown" if it cannot be read.
+ * @param[in] size The size of the model buffer.
+ */
+static void cpu_model(char* const model, const size_t size) {
+	snprintf(model, size, "unknown");
+	FILE* const cpuinfo = fopen("/proc/cpuinfo", "r");
+	if (!cpuinfo)
+		return;
+	char line[TUNE_LINE_MAX];
+	while (fgets(line, sizeof(line), cpuinfo)) {
+		const char* const colon = strchr(line, ':');
+		if (strncmp(line, "model name", strlen("model name")) || !colon)
+			continue;
+		// the model name becomes a field of the cache, so it must hold no tabs
+		snprintf(model, size, "%s", colon + 1 + (colon[1] == ' '));
+		for (char* c = model; *c; c++)
+			if (*c == '\t' || *c == '\n')
+				*c = *c == '\t' ? ' ' : '\0';
+		break;
+	}
+	fclose(cpuinfo);
+}
+
+/**
+ * @brief Look up the plan of a third-order tensor in the tuning cache.
+ * @param[in,out] tensor3 The third-order tensor to plan.
+ * @param[in] path The path of the cache file.
+ * @param[in] model The model name of the processor.
+ * @return true if the cache held a plan for the processor and the tensor's
+ *         dimension and channels, false otherwise
+ *
+ * Every line of the cache is a plan: the model name, the dimension, and the
+ * number of channels, followed by the kernel of every axis in the order of
+ * axis_t, all separated by tabs.
+ */
+static bool tune_cache_load(tensor3_t* const tensor3, const char* const path, const char* const model) {
+	FILE* const cache = fopen(path, "r");
+	if (!cache)
+		return false;
+	char line[TUNE_LINE_MAX];
+	bool found = false;
+	while (!found && fgets(line, sizeof(line), cache)) {
+		char* state;
+		const char* field = strtok_r(line, "\t\n", &state);
+		unsigned dimension, channels;
+		if (!field || strcmp(field, model)
+			|| !(field = strtok_r(NULL, "\t\n", &state)) || sscanf(field, "%u", &dimension) != 1
+			|| !(field = strtok_r(NULL, "\t\n", &state)) || sscanf(field, "%u", &channels) != 1
+			|| dimension != tensor3->dimension || channels != tensor3->channels)
+			continue;
+		kernel_t plan[AXIS_ZNEGATIVE + 1];
+		found = true;
+		for (axis_t axis = AXIS_XPOSITIVE; found && axis <= AXIS_ZNEGATIVE; axis++)
+			found = (field = strtok_r(NULL, "\t\n", &state)) && kernel_parse(field, &plan[axis]);
+		if (found)
+			memcpy(tensor3->plan, plan, sizeof(plan));
+	}
+	fclose(cache);
+	return found;
+}
+
+/**
+ * @brief Append the plan of a third-order tensor to the tuning cache.
+ * @param[in] tensor3 The tuned third-order tensor.
+ * @param[in] path The path of the cache file.
+ * @param[in] model The model name of the processor.
+ * @return true if the plan was appended, false otherwise
+ */
+static bool tune_cache_store(const tensor3_t* const tensor3, const char* const path, const char* const model) {
+	FILE* const cache = fopen(path, "a");
+	if (!cache)
+		return false;
+	bool result = fprintf(cache, "%s\t%u\t%u", model, tensor3->dimension, tensor3->channels) > 0;
+	for (axis_t axis = AXIS_XPOSITIVE; result && axis <= AXIS_ZNEGATIVE; axis++)
+		result = fprintf(cache, "\t%s", KERNEL_NAMES[tensor3->plan[axis]]) > 0;
+	result = fputc('\n', cache) != EOF && result;
+	return !fclose(cache) && result;
+}
+
+/**
+ * @brief Measure every kernel about every axis and plan the fastest ones.
+ * @param[in,out] tensor3 The third-order tensor to tune.
+ * @return true if every rotation was successful, false otherwise
+ *
+ * Each kernel repeats rounds of four rotations about the same axis, which
+ * leave the tensor unchanged, for at least TUNE_SECONDS.
+ */
+static bool tensor3_tune(tensor3_t* const tensor3) {
+	for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++) {
+		double best = INFINITY;
+		kernel_t fastest = KERNEL_QUARTET;
+		for (kernel_t kernel = KERNEL_QUARTET; kernel < KERNEL_COUNT; kernel++) {
+			tensor3->plan[axis] = kernel;
+			struct timespec start;
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			uint32_t rotations = 0;
+			double seconds;
+			do {
+				for (uint8_t k = 0; k < 4; k++, rotations++)
+					if (!tensor3_rotate(tensor3, axis))
+						return false;
+			} while ((seconds = clock_elapsed(&start)) < TUNE_SECONDS);
+			if (seconds / rotations < best) {
+				best = seconds / rotations;
+				fastest = kernel;
+			}
+		}
+		tensor3->plan[axis] = fastest;
+	}
+	return true;
+}
+
+/**
+ * @brief Plan the kernels of a third-order tensor from the tuning cache,
+ *        tuning and caching the plan on the first run.
+ * @param[in,out] tensor3 The third-order tensor to plan.
+ * @param[in] path The path of the cache file.
+ * @return true if the tensor was planned, false otherwise
+ *
+ * Plans are keyed by the processor model, the dimension, and the number of
+ * channels. Failing to append a new plan to the cache is not an error.
+ */
+bool tensor3_plan(tensor3_t* const tensor3, const char* const path) {
+	char model[TUNE_LINE_MAX / 2];
+	cpu_model(model, sizeof(model));
+	if (tune_cache_load(tensor3, path, model))
+		return true;
+	if (!tensor3_tune(tensor3))
+		return false;
+	tune_cache_store(tensor3, path, model);
+	return true;
+}
+
+/**
+ * @brief Compress a range of sections into their snapshot blocks.
+ * @param[in,out] context The snapshot_t being written.
+ * @param[in] begin The first block to compress.
+ * @param[in] end One past the last block to compress.
+ * @return true if every section was intact, false otherwise
+ *
+ * Block b holds section b % dimension of channel b / dimension, which is the
+ * b-th section-sized run of the buffer. The section is checked against its
+ * checksum first, so that corruption in memory is not saved.
+ */
+static bool snapshot_compress_sections(void* const context, const uint32_t begin, const uint32_t end) {
+	snapshot_t* snapshot = (snapshot_t*)context;
+	const tensor3_t* const tensor3 = snapshot->tensor3;
+	const uint32_t raw_size = tensor3->section_size;
+	for (uint32_t block = begin; block < end; block++) {
+		const uint8_t* const raw = tensor3->buffer + block * raw_size;
+		const uint32_t checksum = crc32c(raw, raw_size);
+		if (tensor3->checksums && checksum != tensor3->checksums[block]) {
+			fprintf(stderr, "section %u of channel %u failed its checksum\n", block % tensor3->dimension, block / tensor3->dimension);
+			return false;
+		}
+		snapshot->index[block] = (snapshot_block_t){
+			.size = lz_compress(raw, raw_size, snapshot->blocks + block * lz_bound(raw_size)),
+			.raw_size = raw_size,
+			.checksum = checksum
+		};
+	}
+	return true;
+}
+
+/**
+ * @brief Check that a block of a snapshot lies within the snapshot file.
+ * @param[in] snapshot The snapshot containing the block.
+ * @param[in] block The block to check.
+ * @return true if the block is valid for the snapshot's tensor, false otherwise
+ */
+static bool snapshot_block_valid(const snapshot_t* const snapshot, const snapshot_block_t* const block) {
+	const uint64_t blocks_start = sizeof(snapshot_header_t) + snapshot->header.block_count * sizeof(snapshot_block_t);
+	return block->raw_size == snapshot->tensor3->section_size
+		&& block->offset >= blocks_start
+		&& block->offset <= snapshot->file_size
+		&& block->size <= snapshot->file_size - block->offset;
+}
+
+/**
+ * @brief Decompress a snapshot block into its section and check it against
+ *        its checksum, which becomes the section's.
+ * @param[in,out] tensor3 The third-order tensor to decompress into.
+ * @param[in] block The index entry of the block.
+ * @param[in] data The compressed block.
+ * @param[in] unit The section to decompress, counted across channels as the
+ *            blocks are.
+ * @return true if the block decompressed to a section matching its checksum,
+ *         false otherwise
+ */
+static bool snapshot_block_decompress(
+	tensor3_t* const tensor3,
+	const snapshot_block_t* const block,
+	const uint8_t* const data,
+	const uint32_t unit
+) {
+	uint8_t* const raw = tensor3->buffer + unit * tensor3->section_size;
+	if (!lz_decompress(data, block->size, raw, tensor3->section_size))
+		return false;
+	if (crc32c(raw, tensor3->section_size) != block->checksum) {
+		fprintf(stderr, "snapshot: section %u of channel %u failed its checksum\n", unit % tensor3->dimension, unit / tensor3->dimension);
+		return false;
+	}
+	if (tensor3->checksums)
+		tensor3->checksums[unit] = block->checksum;
+	return true;
+}
+
+/**
+ * @brief Decompress a range of snapshot blocks into their sections.
+ * @param[in,out] context The snapshot_t being read, holding the whole file.
+ * @param[in] begin The first block to decompress.
+ * @param[in] end One past the last block to decompress.
+ * @return true if every block was valid and intact, false otherwise
+ */
+static bool snapshot_decompress_sections(void* const context, const uint32_t begin, const uint32_t end) {
+	snapshot_t* snapshot = (snapshot_t*)context;
+	for (uint32_t idx = begin; idx < end; idx++) {
+		const snapshot_block_t* block = &snapshot->index[idx];
+		if (!snapshot_block_valid(snapshot, block)
+			|| !snapshot_block_decompress(snapshot->tensor3, block, snapshot->blocks + block->offset, idx))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Save a compressed snapshot of a third-order tensor.
+ * @param[in] tensor3 The third-order tensor to save.
+ * @param[in] path The path of the snapshot file.
+ * @return true if the snapshot was saved, false otherwise
+ *
+ * Every section of every channel is checked against its checksum and
+ * compressed independently into a block, in parallel. The file consists of a
+ * snapshot_header_t, an index of one snapshot_block_t per block, and the
+ * compressed blocks. Fields are stored in
+ * host byte order. Identical blocks are written once, and the index entries
+ * of all their sections hold the same offset.
+ */
+bool tensor3_snapshot_save(tensor3_t* const tensor3, const char* const path) {
+	const uint32_t block_count = (uint32_t)tensor3->channels * tensor3->dimension;
+	snapshot_t snapshot = {
+		.tensor3 = tensor3,
+		.header = {
+			.magic = SNAPSHOT_MAGIC,
+			.dimension = tensor3->dimension,
+			.block_count = block_count
+		}
+	};
+	if (!tensor3_normalize(tensor3) || !tensor3_thaw_all(tensor3))
+		return false;
+	const uint32_t bound = lz_bound(tensor3->section_size);
+	snapshot.index = (snapshot_block_t*)memory_calloc(MEMORY_SNAPSHOT, block_count, sizeof(snapshot_block_t));
+	snapshot.blocks = (uint8_t*)memory_alloc(MEMORY_SNAPSHOT, (size_t)bound * block_count);
+	// open addressing over twice as many slots as blocks, holding block + 1
+	const uint32_t slot_count = 2 * block_count;
+	uint32_t* const slots = (uint32_t*)memory_calloc(MEMORY_SNAPSHOT, slot_count, sizeof(uint32_t));
+	bool result = snapshot.index && snapshot.blocks && slots
+		&& parallel_for(block_count, snapshot_compress_sections, &snapshot);
+	if (result) {
+		const uint64_t blocks_start = sizeof(snapshot_header_t) + block_count * sizeof(snapshot_block_t);
+		uint64_t offset = blocks_start;
+		for (uint32_t block = 0; block < block_count; block++) {
+			const uint8_t* const data = snapshot.blocks + block * bound;
+			const uint32_t size = snapshot.index[block].size;
+			uint32_t slot = block_hash(HASH_SEED, data, size) % slot_count;
+			while (slots[slot]) {
+				const uint32_t other = slots[slot] - 1;
+				if (snapshot.index[other].size == size && !memcmp(snapshot.blocks + other * bound, data, size))
+					break;
+				slot = (slot + 1) % slot_count;
+			}
+			if (slots[slot]) {
+				snapshot.index[block].offset = snapshot.index[slots[slot] - 1].offset;
+				continue;
+			}
+			slots[slot] = block + 1;
+			snapshot.index[block].offset = offset;
+			offset += size;
+		}
+		const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		result = fd >= 0
+			&& fd_write_all(fd, &snapshot.header, sizeof(snapshot.header))
+			&& fd_write_all(fd, snapshot.index, block_count * sizeof(snapshot_block_t));
+		// blocks first seen are exactly those whose offset continues the file
+		uint64_t written = blocks_start;
+		for (uint32_t block = 0; result && block < block_count; block++) {
+			if (snapshot.index[block].offset != written)
+				continue;
+			result = fd_write_all(fd, snapshot.blocks + block * bound, snapshot.index[block].size);
+			written += snapshot.index[block].size;
+		}
+		if (fd >= 0)
+			result = !close(fd) && result;
+	}
+	memory_free(MEMORY_SNAPSHOT, slots);
+	memory_free(MEMORY_SNAPSHOT, snapshot.blocks);
+	memory_free(MEMORY_SNAPSHOT, snapshot.index);
+	tensor3_cold_evict(tensor3);
+	return result;
+}
+
+/**
+ * @brief Open a snapshot file and read its header and block index.
+ * @param[out] snapshot The snapshot to read the header and index into.
+ * @param[in] tensor3 The third-order tensor the snapshot will be loaded into.
+ * @param[in] path The path of the snapshot file.
+ * @return The open file descriptor, or -1 if the snapshot is invalid
+ *
+ * On success, the caller must close the descriptor and free the index.
+ */
+static int tensor3_snapshot_open(
+	snapshot_t* const snapshot,
+	tensor3_t* const tensor3,
+	const char* const path
+) {
+	*snapshot = (snapshot_t){ .tensor3 = tensor3 };
+	const uint32_t block_count = (uint32_t)tensor3->channels * tensor3->dimension;
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	struct stat status;
+	if (!fstat(fd, &status)
+		&& fd_read_all(fd, &snapshot->header, sizeof(snapshot->header), 0)
+		&& !memcmp(snapshot->header.magic, SNAPSHOT_MAGIC, sizeof(snapshot->header.magic))
+		&& snapshot->header.dimension == tensor3->dimension
+		&& snapshot->header.block_count == block_count) {
+		snapshot->file_size = status.st_size;
+		snapshot->index = (snapshot_block_t*)memory_alloc(MEMORY_SNAPSHOT, block_count * sizeof(snapshot_block_t));
+		if (snapshot->index
+			&& fd_read_all(fd, snapshot->index, block_count * sizeof(snapshot_block_t), sizeof(snapshot->header)))
+			return fd;
+		memory_free(MEMORY_SNAPSHOT, snapshot->index);
+	}
+	close(fd);
+	return -1;
+}
+
+/**
+ * @brief Load a compressed snapshot into a third-order tensor.
+ * @param[in,out] tensor3 The third-order tensor to load into.
+ * @param[in] path The path of the snapshot file.
+ * @return true if the snapshot was loaded, false otherwise
+ *
+ * The snapshot must have the same dimension and number of channels as the
+ * tensor. The whole file is read at once and its blocks are decompressed and
+ * checked against their checksums in parallel. If the load fails partway,
+ * the checksums are recomputed for whatever the tensor was left holding.
+ */
+bool tensor3_snapshot_load(tensor3_t* const tensor3, const char* const path) {
+	snapshot_t snapshot;
+	const int fd = tensor3_snapshot_open(&snapshot, tensor3, path);
+	if (fd < 0)
+		return false;
+	snapshot.blocks = (uint8_t*)memory_alloc(MEMORY_SNAPSHOT, snapshot.file_size);
+	const bool result = snapshot.blocks
+		&& tensor3_normalize(tensor3)
+		&& tensor3_thaw_all(tensor3)
+		&& fd_read_all(fd, snapshot.blocks, snapshot.file_size, 0)
+		&& parallel_for(snapshot.header.block_count, snapshot_decompress_sections, &snapshot);
+	if (!result && tensor3_thaw_all(tensor3))
+		tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	close(fd);
+	memory_free(MEMORY_SNAPSHOT, snapshot.blocks);
+	memory_free(MEMORY_SNAPSHOT, snapshot.index);
+	tensor3_cold_evict(tensor3);
+	return result;
+}
+
+/**
+ * @brief Load a single section of a compressed snapshot into a third-order
+ *        tensor, leaving the other sections untouched.
+ * @param[in,out] tensor3 The third-order tensor to load into.
+ * @param[in] path The path of the snapshot file.
+ * @param[in] section The section to load.
+ * @return true if the section was loaded, false otherwise
+ *
+ * Only the index and the blocks of the requested section are read.
+ */
+bool tensor3_snapshot_load_section(
+	tensor3_t* const tensor3,
+	const char* const path,
+	const uint8_t* const section
+) {
+	if (*section >= tensor3->dimension)
+		return false;
+	snapshot_t snapshot;
+	const int fd = tensor3_snapshot_open(&snapshot, tensor3, path);
+	if (fd < 0)
+		return false;
+	snapshot.blocks = (uint8_t*)memory_alloc(MEMORY_SNAPSHOT, lz_bound(tensor3->section_size));
+	bool result = snapshot.blocks && tensor3_normalize(tensor3) && tensor3_section_touch(tensor3, section);
+	for (uint8_t channel = 0; result && channel < tensor3->channels; channel++) {
+		const uint32_t idx = channel * tensor3->dimension + *section;
+		const snapshot_block_t* block = &snapshot.index[idx];
+		result = snapshot_block_valid(&snapshot, block)
+			&& block->size <= lz_bound(tensor3->section_size)
+			&& fd_read_all(fd, snapshot.blocks, block->size, block->offset)
+			&& snapshot_block_decompress(tensor3, block, snapshot.blocks, idx);
+	}
+	if (!result && tensor3_section_touch(tensor3, section))
+		tensor3_checksum_sections(tensor3, *section, 1);
+	close(fd);
+	memory_free(MEMORY_SNAPSHOT, snapshot.blocks);
+	memory_free(MEMORY_SNAPSHOT, snapshot.index);
+	return result;
+}
+
+/**
+ * @brief Set up the fields of a third-order tensor, without a buffer.
+ * @param[out] tensor3 The third-order tensor to set up.
+ * @param[in] config The shape of the tensor.
+ * @return true if the shape is valid, false otherwise
+ */
+static bool tensor3_setup(tensor3_t* const tensor3, const tensor3_config_t* const config) {
+	if (config->dimension < TENSOR3_DIM_MIN
+		|| config->dimension > TENSOR3_DIM_MAX
+		|| config->channels > TENSOR3_CHANNELS_MAX)
+		return false;
+	tensor3->buffer = NULL;
+	tensor3->dimension = config->dimension;
+	tensor3->section = 0;
+	tensor3->section_size = tensor3->dimension * tensor3->dimension;
+	tensor3->size = tensor3->section_size * tensor3->dimension;
+	tensor3->channels = config->channels ? config->channels : 1;
+	tensor3->channel = 0;
+	tensor3->intensity_channels = config->intensity_channels;
+	tensor3->kernel = config->kernel;
+	for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++)
+		tensor3->plan[axis] = config->kernel;
+	tensor3->pending = symmetry_identity();
+	memset(tensor3->origin, 0, sizeof(tensor3->origin));
+	tensor3->wrapped = false;
+	tensor3->checksums = NULL;
+	tensor3->cold = NULL;
+	tensor3->slabs = NULL;
+	tensor3->metrics = NULL;
+	return true;
+}
+
+/**
+ * @brief Allocate the buffer and the checksums of a third-order tensor,
+ *        leaving its elements unset.
+ * @param[out] tensor3 The third-order tensor to allocate.
+ * @param[in] config The shape of the tensor and the subsystems to enable.
+ * @return true if the third-order tensor was allocated, false otherwise
+ */
+static bool tensor3_allocate(tensor3_t* const tensor3, const tensor3_config_t* const config) {
+	if (!tensor3_setup(tensor3, config))
+		return false;
+	const size_t buffer_size = (size_t)tensor3->channels * tensor3->size;
+	if (config->workers) {
+		// slab workers share the front and back buffers of all-to-all exchanges
+		tensor3->buffer = (uint8_t*)memory_map(MEMORY_SLABS, 2 * buffer_size, MAP_SHARED);
+	} else {
+		tensor3->buffer = buffer_alloc(buffer_size);
+	}
+	if (!tensor3->buffer)
+		return false;
+	tensor3->checksums = (uint32_t*)memory_alloc(MEMORY_TENSOR, (size_t)tensor3->channels * tensor3->dimension * sizeof(uint32_t));
+	if (tensor3->checksums)
+		return true;
+	if (config->workers)
+		memory_unmap(MEMORY_SLABS, tensor3->buffer, 2 * buffer_size);
+	else
+		memory_free(MEMORY_TENSOR, tensor3->buffer);
+	tensor3->buffer = NULL;
+	return false;
+}
+
+/**
+ * @brief Start the slab workers and the metrics writer of a filled
+ *        third-order tensor, if requested.
+ * @param[in,out] tensor3 The third-order tensor to start the subsystems of.
+ * @param[in] config The subsystems to enable.
+ * @return true if every requested subsystem started, false otherwise
+ */
+static bool tensor3_start(tensor3_t* const tensor3, const tensor3_config_t* const config) {
+	if (config->workers && !tensor3_slabs_init(tensor3, &config->workers))
+		return false;
+	// the writer thread starts after the slab workers are forked
+	if (config->metrics_path)
+		tensor3->metrics = metrics_start(config->metrics_path, tensor3->dimension, tensor3->channels);
+	return !config->metrics_path || tensor3->metrics;
+}
+
+/**
+ * @brief Letter a section of every channel of a third-order tensor.
+ * @param[in,out] tensor3 The third-order tensor to fill.
+ * @param[in] section The section to letter, which must be hot.
+ *
+ * Channels 0, 1 and 2 are lettered by z, y and x, respectively, and further
+ * channels repeat them.
+ */
+static void tensor3_letter_section(tensor3_t* const tensor3, const uint8_t section) {
+	const uint32_t strides[3] = { tensor3->section_size, tensor3->dimension, 1 };
+	const size_t begin = (size_t)section * tensor3->section_size, end = begin + tensor3->section_size;
+	for (uint8_t channel = 0; channel < tensor3->channels; channel++) {
+		uint8_t* plane = tensor3->buffer + channel * tensor3->size;
+		for (size_t i = begin; i < end; i++)
+			plane[i] = (i / strides[channel % 3]) % tensor3->dimension % ('Z' - 'A') + 'A';
+	}
+}
+
+/**
+ * @brief Initialize a third-order tensor owning its buffer.
+ * @param[out] tensor3 The third-order tensor to initialize.
+ * @param[in] config The shape of the tensor and the subsystems to enable.
+ * @return true if the third-order tensor was initialized, false otherwise
+ *
+ * The elements are imported from a raw volume file if one was given;
+ * otherwise, every section of the first channel is filled with a single
+ * letter, and further channels are lettered along the other axes. Every
+ * section is checksummed. If cold sections are compressed, the cold store is
+ * created before the tensor is filled a section at a time, so that only the
+ * hot sections are ever resident; the address space of the whole buffer is
+ * still reserved. Afterwards, the tensor is split among worker processes, if
+ * requested.
+ */
+bool tensor3_init(tensor3_t* const tensor3, const tensor3_config_t* const config) {
+	if (!tensor3_allocate(tensor3, config))
+		return false;
+	// the unfilled sections are checksummed as they are, to thaw them intact
+	if (config->hot_sections
+		&& !(tensor3_checksum_sections(tensor3, 0, tensor3->dimension)
+			&& tensor3_cold_init(tensor3, &config->hot_sections)))
+		return false;
+	if (config->import_path) {
+		if (!tensor3_import(tensor3, config->import_path))
+			return false;
+	} else {
+		for (uint8_t section = 0; section < tensor3->dimension; section++) {
+			if (!tensor3_section_touch(tensor3, &section))
+				return false;
+			tensor3_letter_section(tensor3, section);
+			if (tensor3->cold)
+				tensor3_checksum_sections(tensor3, section, 1);
+		}
+		if (!tensor3->cold)
+			tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+	}
+	return tensor3_start(tensor3, config);
+}
+
+/**
+ * @brief Initialize a third-order tensor over a buffer owned by the caller,
+ *        without copying it.
+ * @param[out] tensor3 The third-order tensor to initialize.
+ * @param[in,out] buffer The elements, laid out as tensor3_t describes: one
+ *                plane of dimension^3 bytes per channel.
+ * @param[in] dimension The dimension of the tensor.
+ * @param[in] channels The number of channels of every element.
+ * @return true if the third-order tensor was initialized, false otherwise
+ *
+ * Operations rotate the caller's buffer in place; those writing every element
+ * to a back buffer copy the result into it. The tensor never frees the
+ * buffer, keeps no checksums, and cannot be split into slabs or compress cold
+ * sections.
+ */
+bool tensor3_wrap(tensor3_t* const tensor3, uint8_t* const buffer, const uint8_t dimension, const uint8_t channels) {
+	const tensor3_config_t config = { .dimension = dimension, .channels = channels };
+	if (!buffer || !tensor3_setup(tensor3, &config))
+		return false;
+	tensor3->buffer = buffer;
+	tensor3->wrapped = true;
+	return true;
+}
+
+/**
+ * @brief Release everything a third-order tensor holds: its buffer, the
+ *        checksums, the cold store, the slab workers, and the metrics writer.
+ * @param[in,out] tensor3 The third-order tensor to release.
+ *
+ * Slab workers exit once their sockets are closed, and are waited for. The
+ * buffer of a wrapped tensor is left to the caller.
+ */
+void tensor3_free(tensor3_t* const tensor3) {
+	metrics_stop(tensor3->metrics);
+	tensor3->metrics = NULL;
+	tensor3_cold_free(tensor3);
+	memory_free(MEMORY_TENSOR, tensor3->checksums);
+	tensor3->checksums = NULL;
+	slab_pool_t* const pool = tensor3->slabs;
+	if (pool) {
+		for (uint8_t worker = 0; worker < pool->workers; worker++)
+			close(pool->sockets[worker]);
+		for (uint8_t worker = 0; worker < pool->workers; worker++)
+			waitpid(pool->pids[worker], NULL, 0);
+		memory_unmap(MEMORY_SLABS, pool->halves[0], 2 * (size_t)tensor3->channels * tensor3->size);
+		memory_free(MEMORY_SLABS, pool);
+		tensor3->slabs = NULL;
+	} else if (!tensor3->wrapped) {
+		memory_free(MEMORY_TENSOR, tensor3->buffer);
+	}
+	tensor3->buffer = NULL;
+}
+
+/**
+ * @brief Draw the next number of a xorshift sequence.
+ * @param[in,out] state The state of the sequence, which must not be zero.
+ * @return The next number.
+ */
+static uint32_t random_next(uint32_t* const state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+/**
+ * @brief Apply a symmetry to the reference tensor element by element.
+ * @param[in,out] tensor3 The reference tensor, whose sections are all hot.
+ * @param[in] symmetry The symmetry to apply.
+ * @return true if the symmetry was applied, false otherwise
+ *
+ * Every coordinate is read from a copy of the elements at the coordinate the
+ * symmetry moves to it, as symmetry_t describes, without any kernel.
+ */
+static bool verify_transform(tensor3_t* const tensor3, const symmetry_t* const symmetry) {
+	const size_t buffer_size = (size_t)tensor3->channels * tensor3->size;
+	uint8_t* const previous = (uint8_t*)memory_alloc(MEMORY_SCRATCH, buffer_size);
+	if (!previous)
+		return false;
+	memcpy(previous, tensor3->buffer, buffer_size);
+	const uint8_t last = tensor3->dimension - 1;
+	for (uint8_t z = 0; z < tensor3->dimension; z++)
+		for (uint8_t y = 0; y < tensor3->dimension; y++)
+			for (uint8_t x = 0; x < tensor3->dimension; x++) {
+				const uint8_t destination[3] = { x, y, z };
+				uint8_t source[3];
+				for (uint8_t k = 0; k < 3; k++)
+					source[symmetry->permutation[k]] = symmetry->reflections[k] ? last - destination[k] : destination[k];
+				const coordinate_t to = { x, y, z }, from = { source[0], source[1], source[2] };
+				const uint32_t target = tensor3_coord_to_index(&to, tensor3);
+				const uint32_t origin = tensor3_coord_to_index(&from, tensor3);
+				for (uint8_t channel = 0; channel < tensor3->channels; channel++)
+					tensor3->buffer[channel * tensor3->size + target] = previous[channel * tensor3->size + origin];
+			}
+	memory_free(MEMORY_SCRATCH, previous);
+	return tensor3_checksum_sections(tensor3, 0, tensor3->dimension);
+}
+
+/**
+ * @brief Save a third-order tensor to a temporary snapshot and load it back.
+ * @param[in,out] tensor3 The third-order tensor to round-trip.
+ * @return true if the tensor was saved and loaded, false otherwise
+ *
+ * The tensor is mirrored between the save and the load, so that it only
+ * matches its reference again if the load restores every element.
+ */
+static bool verify_snapshot(tensor3_t* const tensor3) {
+	char path[] = "/tmp/tensor3-verify-XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd < 0)
+		return false;
+	close(fd);
+	const symmetry_t mirror = symmetry_from_mirror(0);
+	bool result = tensor3_snapshot_save(tensor3, path);
+	tensor3_queue(tensor3, &mirror);
+	result = tensor3_flush(tensor3) && result && tensor3_snapshot_load(tensor3, path);
+	unlink(path);
+	return result;
+}
+
+/**
+ * @brief Apply an operation of a verification sequence to a variant.
+ * @param[in,out] tensor3 The third-order tensor of the variant.
+ * @param[in] variant How the variant applies the operation.
+ * @param[in] operation The operation to apply.
+ * @return true if the operation was applied, false otherwise
+ *
+ * Rotations, mirrors, and symmetries of queued variants are only queued; any
+ * other operation flushes them first, as keyboard input does. Other variants
+ * pass mirrors and symmetries through the queue and flush it at once.
+ * Resizes grow or shrink the tensor and restore its dimension, so that the
+ * regions of later operations still fit.
+ */
+static bool verify_apply(tensor3_t* const tensor3, const verify_variant_t* const variant, const verify_operation_t* const operation) {
+	const bool symmetric = operation->kind == VERIFY_ROTATE
+		|| operation->kind == VERIFY_MIRROR
+		|| operation->kind == VERIFY_SYMMETRY;
+	if (variant->queued && symmetric) {
+		tensor3_queue(tensor3, &operation->symmetry);
+		return true;
+	}
+	if (!tensor3_flush(tensor3))
+		return false;
+	switch (operation->kind) {
+		case VERIFY_ROTATE:
+			return tensor3_rotate(tensor3, operation->axis);
+		case VERIFY_ROTATE_BOX:
+			return tensor3_rotate_box(tensor3, &operation->region, &operation->axis);
+		case VERIFY_SHIFT:
+			tensor3_shift(tensor3, operation->shift_axis, operation->distance);
+			return true;
+		case VERIFY_NORMALIZE:
+			return tensor3_normalize(tensor3);
+		case VERIFY_MIRROR:
+		case VERIFY_SYMMETRY:
+			if (variant->reference)
+				return verify_transform(tensor3, &operation->symmetry);
+			tensor3_queue(tensor3, &operation->symmetry);
+			return tensor3_flush(tensor3);
+		case VERIFY_ROTATE_ANGLE: {
+			bool result = true;
+			if (variant->reference) {
+				for (uint8_t turn = 0; result && turn < operation->turns % 4; turn++)
+					result = tensor3_rotate(tensor3, operation->axis);
+				return result;
+			}
+			const double degrees = 90.0 * operation->turns;
+			return tensor3_rotate_angle(tensor3, &operation->axis, &degrees);
+		}
+		case VERIFY_RESIZE: {
+			const uint8_t dimension = tensor3->dimension;
+			return tensor3_resize(tensor3, operation->resize) && tensor3_resize(tensor3, dimension);
+		}
+		case VERIFY_SNAPSHOT:
+			return variant->reference || verify_snapshot(tensor3);
+		default:
+			return true;
+	}
+}
+
+/**
+ * @brief Compare every element of two third-order tensors of the same shape.
+ * @param[in,out] reference The reference tensor.
+ * @param[in,out] tensor3 The tensor to compare with the reference.
+ * @return true if every channel of every coordinate holds the same byte,
+ *         false otherwise
+ *
+ * Elements are addressed by coordinate, so the origins of the tensors may
+ * differ. Cold sections are thawed first, and the checksums of both tensors
+ * must match their sections.
+ */
+static bool verify_equal(tensor3_t* const reference, tensor3_t* const tensor3) {
+	if (!tensor3_thaw_all(reference) || !tensor3_thaw_all(tensor3))
+		return false;
+	bool equal = true;
+	for (uint8_t z = 0; equal && z < tensor3->dimension; z++)
+		for (uint8_t y = 0; equal && y < tensor3->dimension; y++)
+			for (uint8_t x = 0; equal && x < tensor3->dimension; x++) {
+				const coordinate_t coord = { x, y, z };
+				const uint32_t expected = tensor3_coord_to_index(&coord, reference);
+				const uint32_t actual = tensor3_coord_to_index(&coord, tensor3);
+				for (uint8_t channel = 0; equal && channel < tensor3->channels; channel++)
+					equal = reference->buffer[channel * reference->size + expected]
+						== tensor3->buffer[channel * tensor3->size + actual];
+			}
+	tensor3_cold_evict(reference);
+	tensor3_cold_evict(tensor3);
+	return equal && !tensor3_check(reference) && !tensor3_check(tensor3);
+}
+
+/**
+ * @brief Create the tensor of a verification variant, filled with the same
+ *        random elements as every other variant of the trial.
+ * @param[out] tensor3 The third-order tensor to create.
+ * @param[in] variant The variant to create the tensor for.
+ * @param[in] dimension The dimension of the tensor.
+ * @param[in] channels The number of channels of the tensor.
+ * @param[in] seed The seed of the elements.
+ * @param[in,out] state The random state choosing the variant's parameters.
+ * @return true if the tensor was created, false otherwise
+ */
+static bool verify_create(
+	tensor3_t* const tensor3,
+	const verify_variant_t* const variant,
+	const uint8_t dimension,
+	const uint8_t channels,
+	const uint32_t seed,
+	uint32_t* const state
+) {
+	const tensor3_config_t config = {
+		.dimension = dimension,
+		.channels = channels,
+		.kernel = variant->kernel,
+		.workers = variant->slabs ? (uint8_t)(1 + random_next(state) % (dimension < 4 ? dimension : 4)) : 0
+	};
+	if (!tensor3_init(tensor3, &config))
+		return false;
+	uint32_t elements = seed;
+	for (size_t i = 0; i < (size_t)channels * tensor3->size; i++)
+		tensor3->buffer[i] = (uint8_t)random_next(&elements);
+	tensor3_checksum_sections(tensor3, 0, dimension);
+	if (variant->mixed)
+		for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++)
+			tensor3->plan[axis] = (kernel_t)(random_next(state) % KERNEL_COUNT);
+	const uint8_t hot_max = (uint8_t)(1 + random_next(state) % 3);
+	return !variant->cold || tensor3_cold_init(tensor3, &hot_max);
+}
+
+/**
+ * @brief Verify every kernel and execution path against the quartet kernel
+ *        with random sequences of operations.
+ * @param[in] trials The number of random sequences.
+ * @param[in] seed The seed of the first sequence.
+ * @param[in] dimension_max The largest dimension to verify.
+ * @param[in] channel_count The number of channels of every tensor, or 0 to
+ *            draw one to three channels for every sequence.
+ * @return true if every variant agreed with the quartet kernel after every
+ *         operation, false otherwise
+ *
+ * The first trials cover the smallest odd and even dimensions and the
+ * largest one; the others draw their dimension at random. Every variant runs
+ * the same sequence of rotations, box rotations, cyclic shifts,
+ * normalizations, mirrors, symmetries, resampled quarter turns, resizes, and
+ * snapshot round trips on the same random elements as the reference, and is
+ * compared with it byte for byte after every operation. Tensors split into
+ * slabs cannot be resized, so resizes are left out of their sequences.
+ */
+bool tensor3_verify(const uint32_t trials, const uint32_t seed, const uint8_t dimension_max, const uint8_t channel_count) {
+	uint32_t state = seed ? seed : 1;
+	uint32_t operations = 0;
+	for (uint32_t trial = 0; trial < trials; trial++) {
+		const uint8_t edges[] = { TENSOR3_DIM_MIN, TENSOR3_DIM_MIN + 1, dimension_max };
+		const uint8_t dimension = trial < sizeof(edges)
+			? edges[trial]
+			: (uint8_t)(TENSOR3_DIM_MIN + random_next(&state) % (dimension_max - TENSOR3_DIM_MIN + 1));
+		const uint8_t channels = channel_count ? channel_count : (uint8_t)(1 + random_next(&state) % 3);
+		const uint32_t elements = random_next(&state) | 1;
+		verify_operation_t sequence[VERIFY_SEQUENCE_MAX];
+		const uint8_t length = (uint8_t)(VERIFY_SEQUENCE_MAX / 2 + random_next(&state) % (VERIFY_SEQUENCE_MAX / 2));
+		for (uint8_t k = 0; k < length; k++) {
+			verify_operation_t* const operation = &sequence[k];
+			operation->kind = (verify_kind_t)(random_next(&state) % VERIFY_KIND_COUNT);
+			operation->axis = (axis_t)(random_next(&state) % (AXIS_ZNEGATIVE + 1));
+			operation->region.edge = (uint8_t)(1 + random_next(&state) % dimension);
+			const uint8_t room = dimension - operation->region.edge + 1;
+			operation->region.origin = (coordinate_t){
+				(uint8_t)(random_next(&state) % room),
+				(uint8_t)(random_next(&state) % room),
+				(uint8_t)(random_next(&state) % room)
+			};
+			operation->shift_axis = (uint8_t)(random_next(&state) % 3);
+			operation->distance = (int)(random_next(&state) % (2 * dimension + 1)) - dimension;
+			const uint8_t resize_max = dimension <= TENSOR3_DIM_MAX / 2 ? 2 * dimension : TENSOR3_DIM_MAX;
+			operation->resize = (uint8_t)(TENSOR3_DIM_MIN + random_next(&state) % (resize_max - TENSOR3_DIM_MIN + 1));
+			operation->turns = (uint8_t)(random_next(&state) % 5);
+			// any of the 48 symmetries: a shuffled permutation and three reflections
+			const uint32_t draw = random_next(&state);
+			symmetry_t* const symmetry = &operation->symmetry;
+			*symmetry = symmetry_identity();
+			for (uint8_t k = 2; k > 0; k--) {
+				const uint8_t other = (uint8_t)(random_next(&state) % (k + 1));
+				const uint8_t swapped = symmetry->permutation[k];
+				symmetry->permutation[k] = symmetry->permutation[other];
+				symmetry->permutation[other] = swapped;
+			}
+			for (uint8_t k = 0; k < 3; k++)
+				symmetry->reflections[k] = draw >> k & 1;
+			if (operation->kind == VERIFY_ROTATE)
+				*symmetry = symmetry_from_axis(&operation->axis);
+			else if (operation->kind == VERIFY_MIRROR)
+				*symmetry = symmetry_from_mirror(operation->shift_axis);
+		}
+		const verify_variant_t quartet = { .name = "quartet", .reference = true };
+		for (uint8_t v = 0; v < sizeof(VERIFY_VARIANTS) / sizeof(*VERIFY_VARIANTS); v++) {
+			const verify_variant_t* const variant = &VERIFY_VARIANTS[v];
+			tensor3_t reference, tensor3;
+			if (!verify_create(&reference, &quartet, dimension, channels, elements, &state))
+				return false;
+			bool result = verify_create(&tensor3, variant, dimension, channels, elements, &state);
+			uint8_t k = 0;
+			for (; result && k < length; k++) {
+				if (variant->slabs && sequence[k].kind == VERIFY_RESIZE)
+					continue;
+				result = verify_apply(&reference, &quartet, &sequence[k])
+					&& verify_apply(&tensor3, variant, &sequence[k]);
+				const symmetry_t identity = symmetry_identity();
+				if (result && symmetry_equal(&tensor3.pending, &identity))
+					result = verify_equal(&reference, &tensor3);
+			}
+			result = result && tensor3_flush(&tensor3) && verify_equal(&reference, &tensor3);
+			tensor3_free(&tensor3);
+			tensor3_free(&reference);
+			if (!result) {
+				fprintf(stderr, "verify: %s differs from quartet after %u operations (trial %u, seed %u, dimension %u, channels %u)\n",
+					variant->name, k, trial, seed, dimension, channels);
+				return false;
+			}
+			operations += length;
+		}
+	}
+	printf("verified %u operations in %u trials up to dimension %u (seed %u)\n", operations, trials, dimension_max, seed);
+	return true;
+}
+
+/**
+ * @brief Compare two latencies, for sorting them.
+ * @param[in] first The first latency.
+ * @param[in] second The second latency.
+ * @return A negative, zero, or positive number as the first latency is less
+ *         than, equal to, or greater than the second
+ */
+static int soak_compare(const void* const first, const void* const second) {
+	const uint32_t a = *(const uint32_t*)first, b = *(const uint32_t*)second;
+	return (a > b) - (a < b);
+}
+
+/**
+ * @brief Sum the memory allocated in every category.
+ * @return The allocated bytes.
+ */
+static uint64_t memory_tracked() {
+	uint64_t bytes = 0;
+	for (uint8_t category = 0; category < MEMORY_COUNT; category++)
+		bytes += atomic_load_explicit(&memory_usage[category].current, memory_order_relaxed);
+	return bytes;
+}
+
+/**
+ * @brief Apply a random operation of an interactive session to a third-order
+ *        tensor.
+ * @param[in,out] tensor3 The third-order tensor to operate on.
+ * @param[in,out] state The state of the random sequence.
+ * @param[out] frame The frame a render copies the current section into.
+ * @return true if the operation succeeded, false otherwise
+ *
+ * The operations are weighted like a session: rotations, bursts of typed
+ * ahead symmetries, shifts, section moves, and renders, which copy the
+ * current section as tensor3_render in 3d.c prints it.
+ */
+static bool soak_operate(tensor3_t* const tensor3, uint32_t* const state, uint8_t* const frame) {
+	const uint32_t pick = random_next(state) % 100;
+	if (pick < 40)
+		return tensor3_rotate(tensor3, (axis_t)(random_next(state) % (AXIS_ZNEGATIVE + 1)));
+	if (pick < 55) {
+		for (uint32_t burst = 1 + random_next(state) % 3; burst; burst--) {
+			const axis_t axis = (axis_t)(random_next(state) % (AXIS_ZNEGATIVE + 1));
+			const symmetry_t symmetry = random_next(state) % 4
+				? symmetry_from_axis(&axis)
+				: symmetry_from_mirror((uint8_t)(random_next(state) % 3));
+			tensor3_queue(tensor3, &symmetry);
+		}
+		return tensor3_flush(tensor3);
+	}
+	if (pick < 65) {
+		tensor3_shift(tensor3, (uint8_t)(random_next(state) % 3), random_next(state) % 2 ? 1 : -1);
+		return true;
+	}
+	if (pick < 80) {
+		tensor3->section = (uint8_t)(random_next(state) % tensor3->dimension);
+		tensor3->channel = (uint8_t)(random_next(state) % tensor3->channels);
+		return true;
+	}
+	const uint8_t section = (tensor3->section + tensor3->origin[2]) % tensor3->dimension;
+	if (!tensor3_section_touch(tensor3, &section))
+		return false;
+	const uint8_t* const plane = tensor3->buffer + tensor3->channel * tensor3->size;
+	for (uint8_t y = 0; y < tensor3->dimension; y++) {
+		for (uint8_t x = 0; x < tensor3->dimension; x++) {
+			const coordinate_t coord = { x, y, tensor3->section };
+			frame[y * tensor3->dimension + x] = plane[tensor3_coord_to_index(&coord, tensor3)];
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Run a soak benchmark of random session operations on third-order
+ *        tensors of several dimensions, flagging drift over time.
+ * @param[in] config The shape of the largest tensor and the subsystems to
+ *            enable for every tensor.
+ * @param[in] operations The number of operations to run.
+ * @param[in] seed The seed of the random operations.
+ * @return true if every operation succeeded and no drift was flagged, false
+ *         otherwise
+ *
+ * Tensors of the minimum, the given, and the intermediate dimension live for
+ * the whole run and take turns, a window of SOAK_WINDOW operations at a time.
+ * After every window, the latency percentiles of its operations, the resident
+ * memory, and the heap statistics are printed, with flags for latency creep
+ * beyond SOAK_CREEP_RATIO of the best median of the dimension, resident
+ * memory growth beyond SOAK_SLACK_BYTES since every tensor ran once, and a
+ * fragmented heap holding more free bytes than used ones. Memory still
+ * allocated once the tensors are freed is reported as a leak.
+ */
+bool tensor3_soak(const tensor3_config_t* const config, const uint64_t operations, const uint32_t seed) {
+	uint32_t state = seed ? seed : 1;
+	const uint8_t dimensions[SOAK_DIMENSIONS] = {
+		TENSOR3_DIM_MIN,
+		(uint8_t)((TENSOR3_DIM_MIN + config->dimension) / 2),
+		config->dimension
+	};
+	const uint64_t tracked = memory_tracked();
+	tensor3_t tensors[SOAK_DIMENSIONS];
+	uint8_t created = 0;
+	for (; created < SOAK_DIMENSIONS; created++) {
+		tensor3_config_t shape = *config;
+		shape.dimension = dimensions[created];
+		if (shape.workers > shape.dimension)
+			shape.workers = shape.dimension;
+		if (!tensor3_init(&tensors[created], &shape))
+			break;
+	}
+	uint32_t* const latencies = (uint32_t*)memory_alloc(MEMORY_SCRATCH, SOAK_WINDOW * sizeof(*latencies));
+	uint8_t* const frame = (uint8_t*)memory_alloc(MEMORY_SCRATCH, (size_t)config->dimension * config->dimension);
+	bool result = created == SOAK_DIMENSIONS && latencies && frame;
+	uint32_t best[SOAK_DIMENSIONS] = { 0 };
+	uint64_t resident_baseline = 0;
+	uint32_t creeping = 0, growing = 0, fragmented = 0;
+	uint64_t done = 0;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (uint64_t window = 0; result && done < operations; window++) {
+		const uint8_t turn = window % SOAK_DIMENSIONS;
+		const uint32_t count = operations - done < SOAK_WINDOW ? (uint32_t)(operations - done) : SOAK_WINDOW;
+		for (uint32_t k = 0; result && k < count; k++) {
+			struct timespec operation;
+			clock_gettime(CLOCK_MONOTONIC, &operation);
+			result = soak_operate(&tensors[turn], &state, frame);
+			const double nanoseconds = clock_elapsed(&operation) * 1e9;
+			latencies[k] = nanoseconds < UINT32_MAX ? (uint32_t)nanoseconds : UINT32_MAX;
+		}
+		if (!result)
+			break;
+		done += count;
+		qsort(latencies, count, sizeof(*latencies), soak_compare);
+		const uint32_t median = latencies[count / 2];
+		const uint64_t resident = process_resident_bytes();
+		const struct mallinfo2 heap = mallinfo2();
+		if (window + 1 == SOAK_DIMENSIONS)
+			resident_baseline = resident;
+		const bool creep = best[turn] && median > SOAK_CREEP_RATIO * best[turn];
+		const bool growth = resident_baseline && resident > resident_baseline + SOAK_SLACK_BYTES;
+		const bool fragmentation = heap.fordblks > SOAK_SLACK_BYTES && heap.fordblks > heap.uordblks;
+		if (!best[turn] || median < best[turn])
+			best[turn] = median;
+		creeping += creep;
+		growing += growth;
+		fragmented += fragmentation;
+		printf("window %llu, dimension %u: p50 %.3f us, p99 %.3f us, p99.9 %.3f us, max %.3f us; resident %.1f MiB, heap %.1f MiB used, %.1f MiB free%s%s%s\n",
+			(unsigned long long)window,
+			dimensions[turn],
+			median / 1e3,
+			latencies[(uint64_t)count * 99 / 100] / 1e3,
+			latencies[(uint64_t)count * 999 / 1000] / 1e3,
+			latencies[count - 1] / 1e3,
+			resident / 1048576.0,
+			heap.uordblks / 1048576.0,
+			heap.fordblks / 1048576.0,
+			creep ? " [latency creep]" : "",
+			growth ? " [memory growth]" : "",
+			fragmentation ? " [fragmentation]" : "");
+	}
+	const double seconds = clock_elapsed(&start);
+	for (uint8_t k = 0; k < created; k++)
+		tensor3_free(&tensors[k]);
+	memory_free(MEMORY_SCRATCH, latencies);
+	memory_free(MEMORY_SCRATCH, frame);
+	if (!result) {
+		fprintf(stderr, "soak: operation %llu failed (seed %u)\n", (unsigned long long)done, seed);
+		return false;
+	}
+	const uint64_t leaked = memory_tracked() - tracked;
+	printf("soaked %llu operations on dimensions %u, %u, and %u in %.3f s (seed %u): %u windows of latency creep, %u of memory growth, %u fragmented, %llu bytes leaked\n",
+		(unsigned long long)done,
+		dimensions[0],
+		dimensions[1],
+		dimensions[2],
+		seconds,
+		seed,
+		creeping,
+		growing,
+		fragmented,
+		(unsigned long long)leaked);
+	return !creeping && !growing && !fragmented && !leaked;
+}
+
+/**
+ * @brief Apply a record of an operation log to a third-order tensor.
+ * @param[in,out] tensor3 The third-order tensor to operate on.
+ * @param[in] record The record to apply.
+ * @param[in] path The snapshot file of a snapshot load, or NULL.
+ * @return The result of the operation; for a hash record, whether the hash
+ *         of the tensor matched it
+ *
+ * Applying the records of a tensor's log in order to a copy of it keeps the
+ * copy identical, failures included.
+ */
+bool oplog_apply(tensor3_t* const tensor3, const oplog_record_t* const record, const char* const path) {
+	const axis_t axis = (axis_t)record->axis;
+	const uint8_t value = record->value;
+	switch ((oplog_kind_t)record->kind) {
+		case OPLOG_ROTATE:
+			return axis <= AXIS_ZNEGATIVE && tensor3_rotate(tensor3, axis);
+		case OPLOG_ROTATE_ANGLE:
+			return axis <= AXIS_ZNEGATIVE && tensor3_rotate_angle(tensor3, &axis, &record->degrees);
+		case OPLOG_ROTATE_BOX:
+			return axis <= AXIS_ZNEGATIVE && tensor3_rotate_box(tensor3, &record->region, &axis);
+		case OPLOG_QUEUE:
+			if (!symmetry_valid(&record->symmetry))
+				return false;
+			tensor3_queue(tensor3, &record->symmetry);
+			return true;
+		case OPLOG_FLUSH:
+			return tensor3_flush(tensor3);
+		case OPLOG_SHIFT:
+			if (record->axis > 2)
+				return false;
+			tensor3_shift(tensor3, record->axis, record->distance);
+			return true;
+		case OPLOG_NORMALIZE:
+			return tensor3_normalize(tensor3);
+		case OPLOG_RESIZE:
+			return tensor3_resize(tensor3, value);
+		case OPLOG_SECTION:
+			if (value >= tensor3->dimension)
+				return false;
+			tensor3->section = value;
+			return true;
+		case OPLOG_CHANNEL:
+			if (value >= tensor3->channels)
+				return false;
+			tensor3->channel = value;
+			return true;
+		case OPLOG_SNAPSHOT_LOAD:
+			return path && tensor3_snapshot_load(tensor3, path);
+		case OPLOG_SNAPSHOT_LOAD_SECTION:
+			return path && tensor3_snapshot_load_section(tensor3, path, &value);
+		case OPLOG_HASH:
+			return tensor3_hash(tensor3) == record->hash;
+		case OPLOG_COUNT:
+			break;
+	}
+	return false;
+}
+
+/**
+ * @brief Send a buffer over a socket, retrying short sends.
+ * @param[in] fd The socket to send to.
+ * @param[in] data The data to send.
+ * @param[in] size The number of bytes to send.
+ * @return true if everything was sent, false otherwise
+ *
+ * A closed peer fails the send rather than raising SIGPIPE.
+ */
+static bool socket_send_all(const int fd, const void* const data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	while (size) {
+		const ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR)
+			continue;
+		if (sent <= 0)
+			return false;
+		bytes += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+/**
+ * @brief Receive a buffer from a socket, retrying short receives.
+ * @param[in] fd The socket to receive from.
+ * @param[out] data The buffer to receive into.
+ * @param[in] size The number of bytes to receive.
+ * @return 1 if everything was received, 0 if the peer closed the socket
+ *         before the first byte, and -1 otherwise
+ */
+static int socket_receive_all(const int fd, void* const data, const size_t size) {
+	uint8_t* bytes = (uint8_t*)data;
+	size_t received = 0;
+	while (received < size) {
+		const ssize_t count = recv(fd, bytes + received, size - received, 0);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return !count && !received ? 0 : -1;
+		received += count;
+	}
+	return 1;
+}
+
+/**
+ * @brief Fill the address of a Unix socket.
+ * @param[out] address The address to fill.
+ * @param[in] path The path of the socket.
+ * @return true if the path fits the address, false otherwise
+ */
+static bool socket_address(struct sockaddr_un* const address, const char* const path) {
+	*address = (struct sockaddr_un){ .sun_family = AF_UNIX };
+	if (strlen(path) >= sizeof(address->sun_path))
+		return false;
+	strcpy(address->sun_path, path);
+	return true;
+}
+
+/**
+ * @brief Connect to a standby listening on a Unix socket and sync it with a
+ *        third-order tensor.
+ * @param[in,out] tensor3 The third-order tensor of the primary.
+ * @param[in] path The path of the standby's socket.
+ * @return The connected socket, to send the tensor's operation log to with
+ *         replica_send, or -1 if the standby could not be synced
+ *
+ * Queued symmetries are applied and the origin normalized, then the shape,
+ * the plan, the view, and the buffer are sent. This is the only time the
+ * buffer is sent.
+ */
+int replica_connect(tensor3_t* const tensor3, const char* const path) {
+	struct sockaddr_un address;
+	if (!socket_address(&address, path))
+		return -1;
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	replica_header_t header = {
+		.magic = REPLICA_MAGIC,
+		.dimension = tensor3->dimension,
+		.channels = tensor3->channels,
+		.intensity_channels = tensor3->intensity_channels,
+		.kernel = (uint8_t)tensor3->kernel,
+		.section = tensor3->section,
+		.channel = tensor3->channel
+	};
+	for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++)
+		header.plan[axis] = (uint8_t)tensor3->plan[axis];
+	bool result = !connect(fd, (const struct sockaddr*)&address, sizeof(address))
+		&& tensor3_flush(tensor3)
+		&& tensor3_normalize(tensor3)
+		&& tensor3_thaw_all(tensor3)
+		&& socket_send_all(fd, &header, sizeof(header))
+		&& socket_send_all(fd, tensor3->buffer, (size_t)tensor3->channels * tensor3->size);
+	tensor3_cold_evict(tensor3);
+	if (!result) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * @brief Send a record of the operation log to a standby.
+ * @param[in] fd The socket connected by replica_connect.
+ * @param[in] record The record to send; its path_length is filled in.
+ * @param[in] path The snapshot file of a snapshot load, or NULL.
+ * @return true if the record was sent, false otherwise
+ *
+ * Records are sent in host byte order, followed by the path if any.
+ */
+bool replica_send(const int fd, const oplog_record_t* const record, const char* const path) {
+	oplog_record_t sent;
+	memset(&sent, 0, sizeof(sent));
+	sent.kind = record->kind;
+	sent.axis = record->axis;
+	sent.value = record->value;
+	sent.region = record->region;
+	sent.distance = record->distance;
+	sent.degrees = record->degrees;
+	sent.symmetry = record->symmetry;
+	sent.hash = record->hash;
+	const size_t length = path ? strlen(path) : 0;
+	if (length >= PATH_MAX)
+		return false;
+	sent.path_length = (uint16_t)length;
+	return socket_send_all(fd, &sent, sizeof(sent)) && socket_send_all(fd, path, length);
+}
+
+/**
+ * @brief Run a hot standby: wait for a primary on a Unix socket, sync a
+ *        third-order tensor from it, and apply its operation log until it
+ *        disconnects.
+ * @param[out] tensor3 The third-order tensor to initialize from the primary.
+ * @param[in] config The subsystems to enable for the tensor; its shape is
+ *            taken from the primary.
+ * @param[in] path The path of the socket to listen on.
+ * @return true if the tensor is ready to take over from the primary, false
+ *         if the sync failed or the tensor diverged from the primary
+ *
+ * The primary only sends the records it applied, so every record must apply,
+ * and every hash record is checked against the tensor; either failing means
+ * the tensor diverged and cannot take over. Once allocated, the tensor is
+ * freed on failure.
+ */
+bool tensor3_standby(tensor3_t* const tensor3, const tensor3_config_t* const config, const char* const path) {
+	struct sockaddr_un address;
+	if (!socket_address(&address, path))
+		return false;
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		return false;
+	unlink(path);
+	const bool listening = !bind(listener, (const struct sockaddr*)&address, sizeof(address)) && !listen(listener, 1);
+	const int fd = listening ? accept(listener, NULL, NULL) : -1;
+	close(listener);
+	unlink(path);
+	if (fd < 0) {
+		perror(path);
+		return false;
+	}
+	replica_header_t header;
+	tensor3_config_t shape = *config;
+	if (socket_receive_all(fd, &header, sizeof(header)) != 1
+		|| memcmp(header.magic, REPLICA_MAGIC, sizeof(header.magic))
+		|| header.kernel >= KERNEL_COUNT) {
+		close(fd);
+		return false;
+	}
+	shape.dimension = header.dimension;
+	shape.channels = header.channels;
+	shape.intensity_channels = header.intensity_channels;
+	shape.kernel = (kernel_t)header.kernel;
+	if (shape.workers > shape.dimension)
+		shape.workers = shape.dimension;
+	// the elements are received from the primary instead of being lettered
+	if (!tensor3_allocate(tensor3, &shape)) {
+		close(fd);
+		return false;
+	}
+	bool result = socket_receive_all(fd, tensor3->buffer, (size_t)tensor3->channels * tensor3->size) == 1
+		&& header.section < tensor3->dimension
+		&& header.channel < tensor3->channels
+		&& tensor3_checksum_sections(tensor3, 0, tensor3->dimension)
+		&& tensor3_start(tensor3, &shape)
+		&& (!config->hot_sections || tensor3_cold_init(tensor3, &config->hot_sections));
+	if (result) {
+		for (axis_t axis = AXIS_XPOSITIVE; axis <= AXIS_ZNEGATIVE; axis++)
+			tensor3->plan[axis] = header.plan[axis] < KERNEL_COUNT ? (kernel_t)header.plan[axis] : tensor3->kernel;
+		tensor3->section = header.section;
+		tensor3->channel = header.channel;
+	}
+	uint64_t records = 0;
+	uint32_t checks = 0;
+	while (result) {
+		oplog_record_t record;
+		char snapshot[PATH_MAX];
+		const int status = socket_receive_all(fd, &record, sizeof(record));
+		if (!status)
+			break;
+		result = status == 1
+			&& record.path_length < PATH_MAX
+			&& socket_receive_all(fd, snapshot, record.path_length) >= 0;
+		snapshot[result ? record.path_length : 0] = '\0';
+		const bool applied = result && oplog_apply(tensor3, &record, record.path_length ? snapshot : NULL);
+		checks += result && record.kind == OPLOG_HASH;
+		// the primary only sends records it applied, so any failure diverges
+		if (result && !applied) {
+			if (record.kind == OPLOG_HASH)
+				fprintf(stderr, "standby: diverged from the primary after %llu records\n", (unsigned long long)records);
+			else
+				fprintf(stderr, "standby: record %llu of the primary failed to apply\n", (unsigned long long)records);
+			result = false;
+		}
+		records++;
+	}
+	close(fd);
+	if (!result) {
+		tensor3_free(tensor3);
+		return false;
+	}
+	fprintf(stderr, "standby: primary disconnected after %llu records and %u hash checks, taking over\n",
+		(unsigned long long)records, checks);
+	return true;
+}
+
+/**
+ * @brief Initialize a queue of the batch pipeline.
+ * @param[out] queue The queue to initialize.
+ * @param[in] producers The number of threads pushing to the queue.
+ */
+static void batch_queue_init(batch_queue_t* const queue, const uint8_t producers) {
+	*queue = (batch_queue_t){ .producers = producers };
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+}
+
+/**
+ * @brief Push a job to a queue of the batch pipeline, waiting for room.
+ * @param[in,out] queue The queue to push to.
+ * @param[in] job The job to push.
+ */
+static void batch_queue_push(batch_queue_t* const queue, batch_job_t* const job) {
+	pthread_mutex_lock(&queue->lock);
+	while (queue->count == BATCH_QUEUE_CAPACITY)
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+	queue->jobs[(queue->head + queue->count++) % BATCH_QUEUE_CAPACITY] = job;
+	pthread_cond_signal(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Pop a job from a queue of the batch pipeline, waiting for one.
+ * @param[in,out] queue The queue to pop from.
+ * @return The job, or NULL once the queue is empty and closed.
+ */
+static batch_job_t* batch_queue_pop(batch_queue_t* const queue) {
+	pthread_mutex_lock(&queue->lock);
+	while (!queue->count && queue->producers)
+		pthread_cond_wait(&queue->not_empty, &queue->lock);
+	batch_job_t* job = NULL;
+	if (queue->count) {
+		job = queue->jobs[queue->head];
+		queue->head = (queue->head + 1) % BATCH_QUEUE_CAPACITY;
+		queue->count--;
+		pthread_cond_signal(&queue->not_full);
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return job;
+}
+
+/**
+ * @brief Close a queue of the batch pipeline on behalf of one producer.
+ * @param[in,out] queue The queue to close.
+ *
+ * The consumers are woken once the last producer has closed the queue.
+ */
+static void batch_queue_close(batch_queue_t* const queue) {
+	pthread_mutex_lock(&queue->lock);
+	if (!--queue->producers)
+		pthread_cond_broadcast(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Release a queue of the batch pipeline.
+ * @param[in,out] queue The empty queue to release.
+ */
+static void batch_queue_destroy(batch_queue_t* const queue) {
+	pthread_mutex_destroy(&queue->lock);
+	pthread_cond_destroy(&queue->not_empty);
+	pthread_cond_destroy(&queue->not_full);
+}
+
+/**
+ * @brief Release a job of the batch pipeline and its tensor, counting it as
+ *        failed if it did not complete.
+ * @param[in,out] batch The batch the job belongs to.
+ * @param[in] job The job to release.
+ * @param[in] stage The stage the job failed in, or NULL if it completed.
+ */
+static void batch_job_finish(batch_t* const batch, batch_job_t* const job, const char* const stage) {
+	if (stage) {
+		fprintf(stderr, "batch: %s %s failed\n", job->input, stage);
+		atomic_fetch_add(&batch->failed, 1);
+	} else {
+		atomic_fetch_add(&batch->done, 1);
+	}
+	tensor3_free(&job->tensor3);
+	memory_free(MEMORY_TENSOR, job);
+}
+
+/**
+ * @brief Load the input files of manifest lines into tensors.
+ * @param[in,out] context The batch_t of the pipeline.
+ * @return NULL
+ *
+ * Every line of the manifest holds an input and an output path separated by
+ * whitespace; blank lines and lines starting with # are skipped. The input
+ * file is read whole into a buffer the tensor owns, without the synthetic
+ * fill of tensor3_init.
+ */
+static void* batch_loader(void* const context) {
+	batch_t* const batch = (batch_t*)context;
+	char line[2 * PATH_MAX];
+	while (fgets(line, sizeof(line), batch->manifest)) {
+		char* state;
+		const char* const input = strtok_r(line, " \t\n", &state);
+		const char* const output = input ? strtok_r(NULL, " \t\n", &state) : NULL;
+		if (!input || *input == '#')
+			continue;
+		batch_job_t* const job = output ? (batch_job_t*)memory_alloc(MEMORY_TENSOR, sizeof(batch_job_t)) : NULL;
+		if (!job) {
+			fprintf(stderr, output ? "batch: %s load failed\n" : "batch: %s has no output\n", input);
+			atomic_fetch_add(&batch->failed, 1);
+			continue;
+		}
+		snprintf(job->input, sizeof(job->input), "%s", input);
+		snprintf(job->output, sizeof(job->output), "%s", output);
+		tensor3_setup(&job->tensor3, batch->config);
+		const size_t bytes = (size_t)job->tensor3.channels * job->tensor3.size;
+		job->tensor3.buffer = buffer_alloc(bytes);
+		const int fd = open(input, O_RDONLY);
+		const bool loaded = job->tensor3.buffer && fd >= 0 && fd_read_all(fd, job->tensor3.buffer, bytes, 0);
+		if (fd >= 0)
+			close(fd);
+		if (loaded)
+			batch_queue_push(&batch->loaded, job);
+		else
+			batch_job_finish(batch, job, "load");
+	}
+	batch_queue_close(&batch->loaded);
+	return NULL;
+}
+
+/**
+ * @brief Apply the program to loaded tensors.
+ * @param[in,out] context The batch_t of the pipeline.
+ * @return NULL
+ */
+static void* batch_rotator(void* const context) {
+	batch_t* const batch = (batch_t*)context;
+	batch_job_t* job;
+	while ((job = batch_queue_pop(&batch->loaded))) {
+		tensor3_queue(&job->tensor3, &batch->program);
+		if (tensor3_flush(&job->tensor3))
+			batch_queue_push(&batch->rotated, job);
+		else
+			batch_job_finish(batch, job, "rotation");
+	}
+	batch_queue_close(&batch->rotated);
+	return NULL;
+}
+
+/**
+ * @brief Write rotated tensors to their output files.
+ * @param[in,out] context The batch_t of the pipeline.
+ * @return NULL
+ *
+ * The output holds the elements in buffer order, like the input.
+ */
+static void* batch_storer(void* const context) {
+	batch_t* const batch = (batch_t*)context;
+	batch_job_t* job;
+	while ((job = batch_queue_pop(&batch->rotated))) {
+		const int fd = open(job->output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		bool stored = fd >= 0 && fd_write_all(fd, job->tensor3.buffer, (size_t)job->tensor3.channels * job->tensor3.size);
+		if (fd >= 0)
+			stored = !close(fd) && stored;
+		batch_job_finish(batch, job, stored ? NULL : "store");
+	}
+	return NULL;
+}
+
+/**
+ * @brief Apply a program of symmetries to every tensor file of a manifest.
+ * @param[in] config The shape of every tensor; the subsystems are ignored.
+ * @param[in] manifest_path The path of the manifest, listing an input and an
+ *            output file per line.
+ * @param[in] program The symmetry to apply to every tensor.
+ * @param[in] threads The number of threads of every pipeline stage.
+ * @return true if every tensor was processed, false otherwise
+ *
+ * Input and output files are raw volumes, as read by -i. Loading, rotating,
+ * and storing overlap in a pipeline of stages connected by bounded queues,
+ * which also bound the number of tensors in memory. The throughput of the
+ * whole batch is printed in tensors and bytes per second.
+ */
+bool tensor3_batch(
+	const tensor3_config_t* const config,
+	const char* const manifest_path,
+	const symmetry_t* const program,
+	const uint8_t threads
+) {
+	const uint8_t count = threads < 1 ? 1 : threads > BATCH_THREADS_MAX ? BATCH_THREADS_MAX : threads;
+	tensor3_t shape;
+	if (!tensor3_setup(&shape, config))
+		return false;
+	batch_t batch = { .config = config, .program = *program, .manifest = fopen(manifest_path, "r") };
+	if (!batch.manifest) {
+		perror(manifest_path);
+		return false;
+	}
+	batch_queue_init(&batch.loaded, count);
+	batch_queue_init(&batch.rotated, count);
+	void* (*const stages[])(void*) = { batch_loader, batch_rotator, batch_storer };
+	batch_queue_t* const outputs[] = { &batch.loaded, &batch.rotated, NULL };
+	const uint8_t stage_count = sizeof(stages) / sizeof(*stages);
+	pthread_t workers[sizeof(stages) / sizeof(*stages)][BATCH_THREADS_MAX];
+	bool spawned[sizeof(stages) / sizeof(*stages)][BATCH_THREADS_MAX] = { { false } };
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	// consumers start before their producers; a thread that cannot be created
+	// gives up its place among the producers, and a stage left without threads
+	// keeps the stages before it from starting at all
+	bool started = true;
+	for (uint8_t stage = stage_count; stage-- > 0;) {
+		uint8_t running = 0;
+		for (uint8_t t = 0; t < count; t++) {
+			spawned[stage][t] = started && !pthread_create(&workers[stage][t], NULL, stages[stage], &batch);
+			running += spawned[stage][t];
+			if (!spawned[stage][t] && outputs[stage])
+				batch_queue_close(outputs[stage]);
+		}
+		started = started && running;
+	}
+	for (uint8_t stage = 0; stage < stage_count; stage++)
+		for (uint8_t t = 0; t < count; t++)
+			if (spawned[stage][t])
+				pthread_join(workers[stage][t], NULL);
+	const double seconds = clock_elapsed(&start);
+	fclose(batch.manifest);
+	batch_queue_destroy(&batch.loaded);
+	batch_queue_destroy(&batch.rotated);
+	const uint32_t done = (uint32_t)atomic_load(&batch.done), failed = (uint32_t)atomic_load(&batch.failed);
+	const double bytes = (double)done * shape.channels * shape.size;
+	printf("batch: %u tensors (%u failed) with %u threads per stage in %.3f s: %.1f tensors/s, %.3f GB/s\n",
+		done,
+		failed,
+		count,
+		seconds,
+		seconds > 0 ? done / seconds : 0.0,
+		seconds > 0 ? bytes / seconds / 1e9 : 0.0);
+	return started && !failed;
+}
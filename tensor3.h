@@ -0,0 +1,505 @@
+/**
+ * @file tensor3.h
+ * @brief Rotate a third-order tensor represented by a one-dimensional buffer.
+ * @author Justin Thoreson
+ *
+ * A third-order tensor can be thought of as the three-dimensional equivalent
+ * of an array or matrix. Here, I represent a third-order tensor with a simple
+ * one-dimensional buffer. In this case, the third-order tensor has uniform
+ * dimensions (the width, height, and depth are all equal to one another).
+ *
+ * In the one-dimensional buffer, each index must map to an element. Therefore,
+ * I treat the dimensions of the third-order tensor with the width as the most
+ * significant dimension, the height as the next significant dimension, and the
+ * depth as the least significant dimension. Thus, it follows that whenever the
+ * index increments by one, then the width increases by one; whenever the index
+ * increments to a number divisible by the width, then the height increases by
+ * one; whenever the index increments to a number divisible by the width
+ * multiplied by the height, the depth increases by one. The width corresponds
+ * to the x-axis, the height corresponds to the y-axis, and the depth
+ * corresponds to the z-axis. The positive direction of all axes are in the
+ * direction the dimension and index increases.
+ *
+ *            18 19 20
+ *            21 22 23
+ *            24 25 26
+ *                    /
+ *         9 10 11   /
+ *        12 13 14  / h
+ *        15 16 17 / t
+ *                / p
+ * h   width     / e
+ * e   -----    / d
+ * i | 0 1 2   /
+ * g | 3 4 5  /
+ * h | 6 7 8 /
+ * t
+ *
+ * The engine is built into libtensor3.a and libtensor3.so. A tensor either
+ * owns its buffer (tensor3_init) or wraps one owned by the caller
+ * (tensor3_wrap); either way it is released with tensor3_free.
+ */
+
+#ifndef TENSOR3_H
+#define TENSOR3_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @brief The program's minimum allowed dimension for a third-order tensor.
+ */
+extern const uint8_t TENSOR3_DIM_MIN;
+
+/**
+ * @brief The program's maximum allowed dimension for a third-order tensor.
+ */
+extern const uint8_t TENSOR3_DIM_MAX;
+
+/**
+ * @brief The program's maximum number of channels per element.
+ */
+#define TENSOR3_CHANNELS_MAX 8
+
+/**
+ * @brief The maximum number of worker processes a tensor can be split among.
+ */
+#define TENSOR3_WORKERS_MAX 50
+
+/**
+ * @brief Compressed storage for cold sections, private to the engine.
+ */
+typedef struct cold_store cold_store_t;
+
+/**
+ * @brief Worker processes owning slabs of sections, private to the engine.
+ */
+typedef struct slab_pool slab_pool_t;
+
+/**
+ * @brief Counters written to a metrics file, private to the engine.
+ */
+typedef struct metrics metrics_t;
+
+/**
+ * @brief Enumeration of the operations whose latency is measured.
+ */
+typedef enum {
+	OPERATION_ROTATE,
+	OPERATION_ROTATE_ANGLE,
+	OPERATION_ROTATE_BOX,
+	OPERATION_SYMMETRY,
+	OPERATION_RENDER,
+	OPERATION_RESIZE,
+	OPERATION_CHECKSUM,
+	OPERATION_COUNT,
+} operation_t;
+
+/**
+ * @brief Enumeration of the kernels that can rotate a third-order tensor.
+ *
+ * The quartet kernel is the reference implementation. The hypercube kernel
+ * describes the tensor with strides and rotates it with the rank-N engine.
+ * The permute kernel copies the rotated tensor into a back buffer in a single
+ * pass, as symmetries are applied.
+ */
+typedef enum {
+	KERNEL_QUARTET,
+	KERNEL_HYPERCUBE,
+	KERNEL_PERMUTE,
+	KERNEL_COUNT,
+} kernel_t;
+
+/**
+ * @brief One of the 48 symmetries of a cube: a permutation of the x, y, and z
+ *        coordinates (0, 1, and 2) combined with reflections.
+ *
+ * The element at coordinate s moves to the coordinate d with
+ * d[k] = s[permutation[k]], or dimension - 1 - s[permutation[k]] if
+ * reflections[k] is set. Rotations are the symmetries with an even number of
+ * reflections and an even permutation, or odd ones of both.
+ */
+typedef struct {
+	uint8_t permutation[3];
+	bool reflections[3];
+} symmetry_t;
+
+/**
+ * @brief Enumeration of all axes of a third-order tensor.
+ *
+ * The positive x-axis points to the right.
+ * The negative x-axis points to the left.
+ * The positive y-axis points downward.
+ * The negative y-axis points upward.
+ * The positive z-axis points inward (toward the screen).
+ * The negative z-axis points outward (toward the viewer).
+ *
+ *           -y    +z (far)
+ *             |  /
+ *             | /
+ *             |/
+ *     -x -----+----- +x
+ *            /
+ *           / |
+ *          /  |
+ * (near) -z    +y
+ */
+typedef enum {
+	AXIS_XPOSITIVE,	
+	AXIS_XNEGATIVE,
+	AXIS_YPOSITIVE,	
+	AXIS_YNEGATIVE,
+	AXIS_ZPOSITIVE,	
+	AXIS_ZNEGATIVE,
+} axis_t;
+
+/**
+ * @brief A coordinate representing an element within a third-order tensor.
+ */
+typedef struct {
+	uint8_t x, y, z;
+} coordinate_t;
+
+/**
+ * @brief A cubic region of a third-order tensor, given by the coordinate of
+ *        its corner nearest to the origin and its edge length.
+ */
+typedef struct {
+	coordinate_t origin;
+	uint8_t edge;
+} region_t;
+
+/**
+ * @brief A third-order tensor represented by a one-dimensional buffer.
+ *
+ * Every element has one or more channels, stored as separate planes: the
+ * buffer holds channels * size bytes, and channel c of the element at index i
+ * is at buffer[c * size + i]. The size counts the elements of one plane.
+ * Channels hold symbols, unless their bit is set in intensity_channels.
+ * Symmetries queued in pending are not yet applied to the buffer.
+ *
+ * Addressing wraps around each axis: origin holds the position in the buffer
+ * of coordinate 0 along the x-axis, y-axis, and z-axis, so a cyclic shift
+ * only moves the origin. Kernels addressing the buffer directly rather than
+ * through tensor3_coord_to_index normalize the origin to zero first.
+ *
+ * The plan holds the kernel rotating about every axis; it repeats the
+ * selected kernel unless the tensor has been tuned. A wrapped tensor's buffer
+ * belongs to the caller.
+ *
+ * checksums holds the CRC32C of every section of every channel as stored in
+ * the buffer, at checksums[channel * dimension + section], or is NULL for a
+ * wrapped tensor. Operations keep it up to date.
+ */
+typedef struct {
+	uint8_t* buffer;
+	uint8_t dimension;
+	uint8_t section;
+	uint8_t channels;
+	uint8_t channel;
+	uint8_t intensity_channels;
+	uint16_t section_size;
+	uint32_t size;
+	kernel_t kernel;
+	kernel_t plan[AXIS_ZNEGATIVE + 1];
+	symmetry_t pending;
+	uint8_t origin[3];
+	bool wrapped;
+	uint32_t* checksums;
+	cold_store_t* cold;
+	slab_pool_t* slabs;
+	metrics_t* metrics;
+} tensor3_t;
+
+/**
+ * @brief The shape of a third-order tensor created by tensor3_init, and the
+ *        optional subsystems to enable for it.
+ *
+ * Zero selects one channel, the quartet kernel, synthetic elements, and no
+ * cold store, slab workers, or metrics file.
+ */
+typedef struct {
+	uint8_t dimension;
+	uint8_t channels;
+	uint8_t intensity_channels;
+	kernel_t kernel;
+	const char* import_path;
+	uint8_t hot_sections;
+	uint8_t workers;
+	const char* metrics_path;
+} tensor3_config_t;
+
+/**
+ * @brief Enumeration of the records of an operation log.
+ *
+ * Every operation changing a tensor or the view of it is one record; the
+ * hash record carries the hash of the tensor to check a copy against.
+ */
+typedef enum {
+	OPLOG_ROTATE,
+	OPLOG_ROTATE_ANGLE,
+	OPLOG_ROTATE_BOX,
+	OPLOG_QUEUE,
+	OPLOG_FLUSH,
+	OPLOG_SHIFT,
+	OPLOG_NORMALIZE,
+	OPLOG_RESIZE,
+	OPLOG_SECTION,
+	OPLOG_CHANNEL,
+	OPLOG_SNAPSHOT_LOAD,
+	OPLOG_SNAPSHOT_LOAD_SECTION,
+	OPLOG_HASH,
+	OPLOG_COUNT,
+} oplog_kind_t;
+
+/**
+ * @brief A record of an operation log.
+ *
+ * The axis is an axis_t, or the coordinate of a shift. The value is the
+ * dimension of a resize, the section of a section move or section load, or
+ * the channel of a channel change. Snapshot loads are followed by the path of
+ * the snapshot, of path_length bytes.
+ */
+typedef struct {
+	uint8_t kind;
+	uint8_t axis;
+	uint8_t value;
+	region_t region;
+	int32_t distance;
+	double degrees;
+	symmetry_t symmetry;
+	uint64_t hash;
+	uint16_t path_length;
+} oplog_record_t;
+
+/**
+ * @brief Parse the name of a rotation kernel.
+ */
+bool kernel_parse(const char* const arg, kernel_t* const kernel);
+
+/**
+ * @brief Print the current and peak memory of every category, the resident
+ *        memory, and the page faults of the process.
+ */
+void memory_report(FILE* const stream);
+
+/**
+ * @brief Record an operation in the metrics.
+ */
+void metrics_observe(
+	metrics_t* const metrics,
+	const operation_t operation,
+	const struct timespec* const start,
+	const uint64_t bytes
+);
+
+/**
+ * @brief Make a section hot and mark it as the most recently used.
+ */
+bool tensor3_section_touch(tensor3_t* const tensor3, const uint8_t* const section);
+
+/**
+ * @brief Make every section hot, ahead of an operation on the whole tensor.
+ */
+bool tensor3_thaw_all(tensor3_t* const tensor3);
+
+/**
+ * @brief Calculate the index of a third-order tensor given a coordinate.
+ */
+uint32_t tensor3_coord_to_index(
+	const coordinate_t* const coord,
+	const tensor3_t* const tensor3
+);
+
+/**
+ * @brief Move the elements of a third-order tensor so that its origin is
+ *        zero again, undoing the wrapping of cyclic shifts.
+ */
+bool tensor3_normalize(tensor3_t* const tensor3);
+
+/**
+ * @brief Grow or shrink a third-order tensor, keeping every element that
+ *        remains inside it at its coordinate.
+ */
+bool tensor3_resize(tensor3_t* const tensor3, const uint8_t dimension);
+
+/**
+ * @brief Hash the elements of a third-order tensor in coordinate order.
+ */
+uint64_t tensor3_hash(tensor3_t* const tensor3);
+
+/**
+ * @brief Check every section of a third-order tensor against its checksums.
+ */
+uint32_t tensor3_check(tensor3_t* const tensor3);
+
+/**
+ * @brief Shift a third-order tensor cyclically along an axis.
+ */
+void tensor3_shift(tensor3_t* const tensor3, const uint8_t axis, const int distance);
+
+/**
+ * @brief The symmetry that leaves every element in place.
+ */
+symmetry_t symmetry_identity();
+
+/**
+ * @brief The symmetry of a 90 degree rotation.
+ */
+symmetry_t symmetry_from_axis(const axis_t* const axis);
+
+/**
+ * @brief The symmetry of a reflection.
+ */
+symmetry_t symmetry_from_mirror(const uint8_t coordinate);
+
+/**
+ * @brief Fold two symmetries into one.
+ */
+symmetry_t symmetry_compose(const symmetry_t* const first, const symmetry_t* const second);
+
+/**
+ * @brief Compare two symmetries.
+ */
+bool symmetry_equal(const symmetry_t* const first, const symmetry_t* const second);
+
+/**
+ * @brief Apply any of the 48 symmetries of a cube to a third-order tensor in
+ *        a single pass.
+ */
+bool tensor3_apply_symmetry(tensor3_t* const tensor3, const symmetry_t* const symmetry);
+
+/**
+ * @brief Rotate a third-order tensor 90 degrees.
+ */
+bool tensor3_rotate(tensor3_t* const tensor3, const axis_t axis);
+
+/**
+ * @brief Rotate a cubic region of a third-order tensor 90 degrees in place,
+ *        leaving the rest of the tensor untouched.
+ */
+bool tensor3_rotate_box(tensor3_t* const tensor3, const region_t* const region, const axis_t* const axis);
+
+/**
+ * @brief Sample the current channel of a third-order tensor at a position.
+ */
+uint8_t tensor3_sample(const tensor3_t* const tensor3, const float position[3]);
+
+/**
+ * @brief Build the matrix mapping destination offsets to source offsets for
+ *        a rotation by an arbitrary angle.
+ */
+void resample_matrix(float matrix[3][3], const axis_t* const axis, const double* const degrees);
+
+/**
+ * @brief Rotate a third-order tensor by an arbitrary angle, replacing its
+ *        elements with the resampled ones.
+ */
+bool tensor3_rotate_angle(tensor3_t* const tensor3, const axis_t* const axis, const double* const degrees);
+
+/**
+ * @brief Queue a symmetry to be applied by the next tensor3_flush.
+ */
+void tensor3_queue(tensor3_t* const tensor3, const symmetry_t* const symmetry);
+
+/**
+ * @brief Apply the queued symmetries.
+ */
+bool tensor3_flush(tensor3_t* const tensor3);
+
+/**
+ * @brief Measure the throughput of rotating a third-order tensor.
+ */
+bool tensor3_benchmark(tensor3_t* const tensor3, const uint32_t* const count);
+
+/**
+ * @brief Plan the kernels of a third-order tensor from the tuning cache,
+ *        tuning and caching the plan on the first run.
+ */
+bool tensor3_plan(tensor3_t* const tensor3, const char* const path);
+
+/**
+ * @brief Save a compressed snapshot of a third-order tensor.
+ */
+bool tensor3_snapshot_save(tensor3_t* const tensor3, const char* const path);
+
+/**
+ * @brief Load a compressed snapshot into a third-order tensor.
+ */
+bool tensor3_snapshot_load(tensor3_t* const tensor3, const char* const path);
+
+/**
+ * @brief Load a single section of a compressed snapshot into a third-order
+ *        tensor, leaving the other sections untouched.
+ */
+bool tensor3_snapshot_load_section(
+	tensor3_t* const tensor3,
+	const char* const path,
+	const uint8_t* const section
+);
+
+/**
+ * @brief Initialize a third-order tensor owning its buffer.
+ */
+bool tensor3_init(tensor3_t* const tensor3, const tensor3_config_t* const config);
+
+/**
+ * @brief Initialize a third-order tensor over a buffer owned by the caller,
+ *        without copying it.
+ */
+bool tensor3_wrap(tensor3_t* const tensor3, uint8_t* const buffer, const uint8_t dimension, const uint8_t channels);
+
+/**
+ * @brief Release everything a third-order tensor holds: its buffer, the cold
+ *        store, the slab workers, and the metrics writer.
+ */
+void tensor3_free(tensor3_t* const tensor3);
+
+/**
+ * @brief Verify every kernel and execution path against the quartet kernel
+ *        with random sequences of operations.
+ */
+bool tensor3_verify(const uint32_t trials, const uint32_t seed, const uint8_t dimension_max, const uint8_t channel_count);
+
+/**
+ * @brief Run a soak benchmark of random session operations on third-order
+ *        tensors of several dimensions, flagging drift over time.
+ */
+bool tensor3_soak(const tensor3_config_t* const config, const uint64_t operations, const uint32_t seed);
+
+/**
+ * @brief Apply a record of an operation log to a third-order tensor.
+ */
+bool oplog_apply(tensor3_t* const tensor3, const oplog_record_t* const record, const char* const path);
+
+/**
+ * @brief Connect to a standby listening on a Unix socket and sync it with a
+ *        third-order tensor.
+ */
+int replica_connect(tensor3_t* const tensor3, const char* const path);
+
+/**
+ * @brief Send a record of the operation log to a standby.
+ */
+bool replica_send(const int fd, const oplog_record_t* const record, const char* const path);
+
+/**
+ * @brief Run a hot standby: wait for a primary on a Unix socket, sync a
+ *        third-order tensor from it, and apply its operation log until it
+ *        disconnects.
+ */
+bool tensor3_standby(tensor3_t* const tensor3, const tensor3_config_t* const config, const char* const path);
+
+/**
+ * @brief Apply a program of symmetries to every tensor file of a manifest.
+ */
+bool tensor3_batch(
+	const tensor3_config_t* const config,
+	const char* const manifest_path,
+	const symmetry_t* const program,
+	const uint8_t threads
+);
+
+#endif